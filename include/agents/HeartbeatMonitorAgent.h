@@ -1,21 +1,96 @@
 #ifndef HEARTBEAT_MONITOR_AGENT_H
 #define HEARTBEAT_MONITOR_AGENT_H
 
+#include <cstdint>
+#include <random>
+#include <set>
+#include <unordered_map>
 #include <wrench-dev.h>
 
 namespace wrench {
 
 class JobSchedulingAgent;
+class SwimMessage;
 
+/// PING: probe of the receiver. PING_REQ: request to probe the subject on behalf of the sender. ACK: answer to a probe
+/// of the subject, possibly relayed.
+enum class SwimMessageType { PING, PING_REQ, ACK };
+
+/**
+ * @brief Failure detector of the job scheduling agent running on the same host.
+ *
+ * In HEARTBEAT mode, each monitor sends a heartbeat to every other monitor every period, and suspects those it did not
+ * hear from for longer than the expiration delay (N^2 messages per period). In SWIM mode (Das et al., DSN 2002), each
+ * monitor probes a single member per period, in a shuffled round-robin order, skipping those its job scheduling agent
+ * heard from during the period (job broadcasts and bids piggyback liveness). A member that does not acknowledge the
+ * probe within the probe timeout is probed indirectly through fanout other members, and declared failed if it does not
+ * acknowledge either by the end of the period. Failures are disseminated by piggybacking them on the next messages of
+ * the failure detector. Members declared failed keep being probed.
+ *
+ * In both modes, a member declared failed that is heard from again (e.g., once a link outage is over) is declared
+ * alive again, and the local job scheduling agent is notified of each failure and recovery.
+ *
+ * With an adaptive period, the period doubles, up to a maximum, after every period without activity of the local job
+ * scheduling agent nor failure detection, and snaps back to its initial value as soon as either happens. Heartbeats
+ * carry the period of their sender, after which their receivers expect the next one, so that stretched periods do
+ * not cause false detections.
+ */
 class HeartbeatMonitorAgent : public ExecutionController {
+public:
+  enum class FailureDetector { HEARTBEAT, SWIM };
+
+private:
   std::shared_ptr<JobSchedulingAgent> job_scheduling_agent_;
   double period_;
   double expiration_;
   std::vector<std::shared_ptr<HeartbeatMonitorAgent>> heartbeat_monitor_agent_network_;
   std::map<std::shared_ptr<HeartbeatMonitorAgent>, double> last_heartbeat_time_;
+  std::set<std::shared_ptr<HeartbeatMonitorAgent>> failed_members_;
+  // Periods announced in the last heartbeats of the other members
+  std::map<std::shared_ptr<HeartbeatMonitorAgent>, double> heartbeat_periods_;
+
+  bool adaptive_period_ = false;
+  double max_period_    = 0;
+  double current_period_;
+  bool active_ = false;
+  // Timers of the periods are identified by a counter, so that those superseded when the period snaps back are ignored
+  uint64_t period_timer_id_ = 0;
+
+  FailureDetector failure_detector_ = FailureDetector::HEARTBEAT;
+  size_t swim_fanout_               = 3;
+  double swim_probe_timeout_        = 0;
+  std::mt19937 rng_;
+  size_t next_probe_index_ = 0;
+  std::shared_ptr<HeartbeatMonitorAgent> probed_member_;
+  uint64_t probe_id_ = 0;
+  bool probe_acked_  = true;
+  // Probes run on behalf of other members, whose acknowledgment is to be relayed to them
+  std::unordered_map<uint64_t, std::shared_ptr<HeartbeatMonitorAgent>> relayed_probes_;
+  // Failures still to be piggybacked, and on how many more messages
+  std::vector<std::pair<std::shared_ptr<HeartbeatMonitorAgent>, size_t>> failure_updates_;
+
+  // Date at which this monitor died, if it did
+  double failure_date_ = -1;
+
+  size_t num_periods_             = 0;
+  size_t num_sent_messages_       = 0;
+  size_t num_detections_          = 0;
+  size_t num_false_detections_    = 0;
+  double total_detection_latency_ = 0;
+  double max_detection_latency_   = 0;
 
+  void start_period();
   void send_heartbeats();
   void check_expired_heartbeats();
+  void declare_failed(const std::shared_ptr<HeartbeatMonitorAgent>& member);
+  // Record that a member was heard from, and declare it alive again if it was declared failed
+  void record_heard_from(const std::shared_ptr<HeartbeatMonitorAgent>& member);
+
+  void start_probe();
+  void probe_indirectly();
+  void send_swim_message(const std::shared_ptr<HeartbeatMonitorAgent>& receiver, SwimMessageType type,
+                         const std::shared_ptr<HeartbeatMonitorAgent>& subject, uint64_t probe_id);
+  void process_swim_message(const std::shared_ptr<SwimMessage>& message);
 
   int main() override;
   void processEventCustom(const std::shared_ptr<CustomEvent>& event) override { /* no-op */ };
@@ -27,13 +102,40 @@ public:
       , job_scheduling_agent_(job_scheduling_agent)
       , period_(period)
       , expiration_(expiration)
+      , current_period_(period)
+      , rng_(std::hash<std::string>{}(hostname))
   {
   }
   void add_heartbeat_monitor_agent(std::shared_ptr<HeartbeatMonitorAgent> agent)
   {
     heartbeat_monitor_agent_network_.push_back(agent);
     last_heartbeat_time_[agent] = 0.0;
+    heartbeat_periods_[agent]   = period_;
+  }
+  const std::shared_ptr<JobSchedulingAgent>& get_job_scheduling_agent() const { return job_scheduling_agent_; }
+  void set_failure_detector(FailureDetector failure_detector, size_t fanout, double probe_timeout)
+  {
+    failure_detector_   = failure_detector;
+    swim_fanout_        = fanout;
+    swim_probe_timeout_ = probe_timeout;
   }
+  void set_adaptive_period(double max_period)
+  {
+    adaptive_period_ = true;
+    max_period_      = max_period;
+  }
+  // The local job scheduling agent has jobs in flight
+  void notify_activity();
+  // The local job scheduling agent heard from that of another monitor
+  void record_liveness(const std::shared_ptr<HeartbeatMonitorAgent>& member);
+
+  double get_failure_date() const { return failure_date_; }
+  size_t get_num_periods() const { return num_periods_; }
+  size_t get_num_sent_messages() const { return num_sent_messages_; }
+  size_t get_num_detections() const { return num_detections_; }
+  size_t get_num_false_detections() const { return num_false_detections_; }
+  double get_total_detection_latency() const { return total_detection_latency_; }
+  double get_max_detection_latency() const { return max_detection_latency_; }
 };
 
 } // namespace wrench
@@ -22,6 +22,7 @@ public:
       : ExecutionController(hostname, "job_lifecycle_tracker_agent"), job_list_(job_list)
   {
   }
+  size_t get_num_jobs() const { return job_lifecycles_ ? job_lifecycles_->size() : 0; }
 };
 
 } // namespace wrench
@@ -2,12 +2,22 @@
 #define JOB_SCHEDULING_AGENT_H
 
 #include <memory>
+#include <unordered_map>
 #include <wrench-dev.h>
 
 #include "info/HPCSystemDescription.h"
 #include "info/JobDescription.h"
 #include "policies/SchedulingPolicy.h"
 
+class AvailabilityProfile;
+class BidCache;
+class BidDispatcher;
+class BidPrefetcher;
+class IdleNodeTracker;
+class StartTimeEstimateCache;
+class SystemStatusBoard;
+struct SystemStatusSnapshot;
+
 namespace wrench {
 
 class JobLifecycleTrackerAgent;
@@ -24,15 +34,86 @@ class JobSchedulingAgent : public ExecutionController {
   std::shared_ptr<BatchComputeService> batch_compute_service_;
   std::shared_ptr<JobLifecycleTrackerAgent> tracker_;
   std::shared_ptr<HeartbeatMonitorAgent> heartbeat_monitor_;
+  std::shared_ptr<BidDispatcher> bid_dispatcher_;
+  std::shared_ptr<BidPrefetcher> bid_prefetcher_;
+  std::shared_ptr<BidCache> bid_cache_;
+  std::shared_ptr<IdleNodeTracker> idle_node_tracker_;
+  bool check_idle_nodes_                = false;
+  size_t num_idle_node_inconsistencies_ = 0;
+  std::shared_ptr<StartTimeEstimateCache> start_time_estimate_cache_;
+  std::shared_ptr<AvailabilityProfile> availability_profile_;
+  bool validate_start_time_estimates_ = false;
+  std::shared_ptr<SystemStatusBoard> status_board_;
+
+  // Local bids waiting for their decision time to elapse, keyed by the message of their timer
+  struct PendingBid {
+    std::shared_ptr<JobDescription> job_description;
+    double bid;
+    double decision_time;
+  };
+  std::unordered_map<uint64_t, PendingBid> pending_bids_;
+  uint64_t next_timer_token_ = 0;
+  // Null bids on the jobs that do not pass the acceptance tests of the HPC system, computed natively, and agents that
+  // were not even sent the jobs submitted to this one (see SchedulingPolicy::set_feasibility_prefilter)
+  size_t num_prefiltered_bids_ = 0;
+  size_t num_excluded_bidders_ = 0;
+
+  // Auctions in flight on this agent, from their first bid to the decision, with the number of bids needed as of the
+  // first one (only lowered upon failures)
+  struct Auction {
+    std::shared_ptr<JobDescription> job_description;
+    size_t num_needed_bids;
+    bool past_deadline = false;
+  };
+  std::unordered_map<int, Auction> auctions_;
+  std::unordered_map<uint64_t, int> auction_deadlines_; // job id, keyed by the message of the timer
+  double auction_deadline_                = 0;
+  double auction_quorum_                  = 0;
+  size_t num_auctions_closed_on_deadline_ = 0;
+  size_t num_auctions_closed_on_failure_  = 0;
 
-  std::unordered_map<int, std::map<std::shared_ptr<JobSchedulingAgent>, std::pair<double, double>>> all_bids_;
+  // Jobs submitted to the batch compute service, until they complete or fail for good, with the number of times they
+  // were requeued after a hardware failure
+  struct SubmittedJob {
+    std::shared_ptr<JobDescription> job_description;
+    size_t num_requeues = 0;
+  };
+  std::unordered_map<int, SubmittedJob> submitted_jobs_;
+  size_t max_job_requeues_  = 0;
+  size_t num_requeued_jobs_ = 0;
 
   int main() override;
   void processEventCustom(const std::shared_ptr<CustomEvent>& event) override;
+  void process_message(const std::shared_ptr<ExecutionControllerCustomEventMessage>& message);
   void processEventCompoundJobCompletion(const std::shared_ptr<CompoundJobCompletedEvent>& event) override;
   void processEventCompoundJobFailure(const std::shared_ptr<CompoundJobFailedEvent>& event) override;
   void processEventTimer(const std::shared_ptr<wrench::TimerEvent>& event) override;
+  // Whether this agent runs the auction of a job. With deadlines, the agents of an all-to-all auction could close it
+  // with different bids, and thus winners: only the agent the job was submitted to does, and announces the winner.
+  bool runs_auction_of(const std::shared_ptr<JobDescription>& job_description) const;
+  // Decide on the auction of a job if all the needed bids were received, or if a quorum of them was by the deadline.
+  // Returns true if the auction was closed.
+  bool evaluate_auction(int job_id);
+  void decide_auction(const std::shared_ptr<JobDescription>& job_description,
+                      const std::map<std::shared_ptr<JobSchedulingAgent>, std::pair<double, double>>& all_bids);
+  // This agent won the competitive bidding on a job
+  void schedule_won_job(const std::shared_ptr<JobDescription>& job_description, const std::string& bids);
   void build_and_submit_job(int job_id, const std::shared_ptr<JobDescription>& job_description);
+  // Steps 2 and 3 of the bidding on a job: retrieve the status of the HPC system and compute (or reuse) a bid
+  std::pair<double, double> compute_local_bid(const std::shared_ptr<JobDescription>& job_description);
+  // Record the null bids of the agents excluded from the auction of a job
+  void record_excluded_bids(const std::shared_ptr<JobDescription>& job_description);
+  std::string get_bid_prefetch_key(const std::shared_ptr<JobDescription>& job_description) const;
+  const std::shared_ptr<IdleNodeTracker>& get_idle_node_tracker();
+  // Local state changes, upon which the state derived from the batch compute service is updated
+  void on_job_queued(int job_id, const std::shared_ptr<JobDescription>& job_description);
+  void on_job_started(int job_id, double start_time, const std::vector<std::string>& hostnames);
+  void on_job_ended(int job_id);
+  void on_status_change();
+  std::map<std::pair<size_t, sg_size_t>, double>
+  get_batch_start_time_estimates(const std::set<std::pair<size_t, sg_size_t>>& job_shapes);
+  std::map<std::pair<size_t, sg_size_t>, double>
+  compute_start_time_estimates(const std::set<std::pair<size_t, sg_size_t>>& job_shapes);
 
 public:
   JobSchedulingAgent(const std::string& hostname, const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
@@ -43,6 +124,7 @@ public:
       , scheduling_policy_(scheduling_policy)
       , batch_compute_service_(batch_compute_service)
   {
+    scheduling_policy_->set_hpc_system_description(hpc_system_description_);
   }
 
   void set_scheduling_policy_network(const std::vector<std::shared_ptr<wrench::JobSchedulingAgent>>& network)
@@ -50,11 +132,64 @@ public:
     scheduling_policy_->set_job_scheduling_agent_network(network);
   }
   const std::shared_ptr<HPCSystemDescription>& get_hpc_system_description() const { return hpc_system_description_; }
+  const std::shared_ptr<SchedulingPolicy>& get_scheduling_policy() const { return scheduling_policy_; }
+  // Coalesce the messages sent to the same agent while processing the events of a given date
+  void set_message_coalescing(bool enabled) { scheduling_policy_->outbox_.set_coalescing(enabled); }
 
   const std::shared_ptr<BatchComputeService>& get_batch_compute_service() const { return batch_compute_service_; }
 
   void set_job_lifecycle_tracker(std::shared_ptr<JobLifecycleTrackerAgent> tracker) { tracker_ = tracker; }
   void set_heartbeat_monitor(std::shared_ptr<HeartbeatMonitorAgent> monitor) { heartbeat_monitor_ = monitor; }
+  const std::shared_ptr<HeartbeatMonitorAgent>& get_heartbeat_monitor() const { return heartbeat_monitor_; }
+  void set_bid_dispatcher(std::shared_ptr<BidDispatcher> dispatcher) { bid_dispatcher_ = dispatcher; }
+  void set_bid_prefetcher(std::shared_ptr<BidPrefetcher> prefetcher) { bid_prefetcher_ = prefetcher; }
+  void set_bid_cache(std::shared_ptr<BidCache> cache) { bid_cache_ = cache; }
+  // Close the auctions still in flight after a deadline, scaled by the height of the agent in the aggregation tree,
+  // with the bids received so far, provided they are a quorum (fraction) of the needed bids
+  void set_auction_deadline(double deadline, double quorum)
+  {
+    auction_deadline_ = deadline;
+    auction_quorum_   = quorum;
+  }
+  size_t get_num_auctions_closed_on_deadline() const { return num_auctions_closed_on_deadline_; }
+  size_t get_num_auctions_closed_on_failure() const { return num_auctions_closed_on_failure_; }
+  size_t get_num_prefiltered_bids() const { return num_prefiltered_bids_; }
+  size_t get_num_excluded_bidders() const { return num_excluded_bidders_; }
+  // Resubmit the jobs that fail because compute nodes were turned off, up to this number of times per job, instead of
+  // failing them right away
+  void set_max_job_requeues(size_t max_job_requeues) { max_job_requeues_ = max_job_requeues; }
+  size_t get_num_requeued_jobs() const { return num_requeued_jobs_; }
+  // Some compute nodes of the HPC system were turned off by a hardware failure, or back on
+  void on_compute_nodes_switched(const std::vector<std::string>& hostnames, bool turn_on);
+  size_t get_num_off_nodes();
+  void prefetch_bid(const std::shared_ptr<JobDescription>& job_description);
+  // Number of idle compute nodes, maintained from the start and completion of the jobs of this agent
+  size_t get_number_of_available_nodes();
+  // Compare the idle nodes to those reported by the batch compute service upon every status retrieval
+  void set_idle_node_check(bool check) { check_idle_nodes_ = check; }
+  size_t get_num_idle_node_inconsistencies() const { return num_idle_node_inconsistencies_; }
+  void set_start_time_estimate_cache(std::shared_ptr<StartTimeEstimateCache> cache)
+  {
+    start_time_estimate_cache_ = cache;
+  }
+  const std::shared_ptr<StartTimeEstimateCache>& get_start_time_estimate_cache() const
+  {
+    return start_time_estimate_cache_;
+  }
+  // Estimate start times from an availability profile maintained by this agent instead of asking the batch compute
+  // service, possibly comparing both upon every estimate
+  void set_availability_profile(std::shared_ptr<AvailabilityProfile> profile, bool validate)
+  {
+    availability_profile_          = profile;
+    validate_start_time_estimates_ = validate;
+  }
+  const std::shared_ptr<AvailabilityProfile>& get_availability_profile() const { return availability_profile_; }
+  void set_status_board(std::shared_ptr<SystemStatusBoard> board) { status_board_ = board; }
+  // Job-independent part of the status of the HPC system, as published on the status board if any
+  std::shared_ptr<const SystemStatusSnapshot> get_status_snapshot();
+  double get_job_start_time_estimate(const std::shared_ptr<JobDescription>& job_description);
+  // Estimate the start times of several jobs (e.g., arriving at the same date) in a single call to the batch service
+  void estimate_job_start_times(const std::vector<std::shared_ptr<JobDescription>>& job_descriptions);
   void mark_agent_as_failed(std::shared_ptr<JobSchedulingAgent> agent);
   const std::string& get_hpc_system_name() const { return hpc_system_description_->get_name(); }
 };
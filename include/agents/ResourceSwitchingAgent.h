@@ -3,10 +3,24 @@
 
 #include <nlohmann/json.hpp>
 #include <simgrid/s4u.hpp>
+#include <unordered_map>
 #include <wrench-dev.h>
 
 namespace wrench {
 
+class JobSchedulingAgent;
+
+/**
+ * @brief Injects the hardware failures of a failure profile. Each event of the profile turns off, at a given date,
+ * either a fraction of the compute nodes of an HPC system (the first host of each cluster being its head node, which
+ * is spared) or a link, and possibly turns it back on at a later date.
+ *
+ * The transitions of all events are sorted by date once, and a single timer is pending at any time, for the date of
+ * the next transition, rather than one per transition. The compute nodes of each HPC system are resolved once and kept
+ * in a random (but reproducible) order, partitioned into the nodes that are off and those that are on, so that turning
+ * a fraction of a system off or back on costs the number of affected nodes, regardless of the size of the system. The
+ * job scheduling agent of the system is notified once per transition, with all the affected nodes.
+ */
 class ResourceSwitchingAgent : public ExecutionController {
 private:
   std::map<std::string, std::vector<std::string>> clusters_;
@@ -17,12 +31,35 @@ private:
     double fraction = 1.0;
     double turn_off_time;
     double turn_on_time = -1.0;
+    // Compute nodes turned off by this event
+    std::vector<simgrid::s4u::Host*> hosts;
   };
 
   std::vector<FailureEvent> failure_events_;
 
+  struct Transition {
+    double date;
+    size_t event; // index in failure_events_
+    bool turn_on;
+  };
+  std::vector<Transition> transitions_; // by date
+  size_t next_transition_ = 0;
+
+  // Compute nodes of an HPC system, the first num_off ones being off
+  struct ComputeNodes {
+    std::vector<simgrid::s4u::Host*> hosts;
+    std::unordered_map<simgrid::s4u::Host*, size_t> positions;
+    size_t num_off = 0;
+    std::shared_ptr<JobSchedulingAgent> agent;
+  };
+  std::map<std::string, ComputeNodes> compute_nodes_;
+
+  size_t num_node_failures_ = 0;
+
   void parse_failure_profile(const std::string& json_file);
-  void schedule_events();
+  void resolve_compute_nodes();
+  void apply(const Transition& transition);
+  void switch_compute_nodes(FailureEvent& event, bool turn_on);
   int main() override;
 
 public:
@@ -32,6 +69,13 @@ public:
   {
     parse_failure_profile(failure_profile);
   }
+
+  // Agents notified when compute nodes of their HPC system are turned off or back on
+  void set_job_scheduling_agent_network(const std::vector<std::shared_ptr<JobSchedulingAgent>>& network);
+
+  size_t get_num_failure_events() const { return failure_events_.size(); }
+  // Compute nodes turned off over the simulation
+  size_t get_num_node_failures() const { return num_node_failures_; }
 };
 
 } // namespace wrench
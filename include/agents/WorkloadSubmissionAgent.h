@@ -3,6 +3,9 @@
 
 #include <wrench-dev.h>
 
+class BidPrefetcher;
+class MessageOutbox;
+
 namespace wrench {
 
 class JobLifecycleTrackerAgent;
@@ -12,6 +15,8 @@ class WorkloadSubmissionAgent : public ExecutionController {
   const std::string& job_list_;
   std::vector<std::shared_ptr<JobSchedulingAgent>> job_scheduling_agents_;
   std::shared_ptr<JobLifecycleTrackerAgent> tracker_;
+  std::shared_ptr<BidPrefetcher> bid_prefetcher_;
+  std::shared_ptr<MessageOutbox> outbox_;
 
   int main() override;
   void processEventCustom(const std::shared_ptr<CustomEvent>& event) override { /* no-op*/ };
@@ -26,6 +31,9 @@ public:
   {
   }
   void set_job_lifecycle_tracker(std::shared_ptr<JobLifecycleTrackerAgent> tracker) { tracker_ = tracker; }
+  void set_bid_prefetcher(std::shared_ptr<BidPrefetcher> prefetcher) { bid_prefetcher_ = prefetcher; }
+  // Coalesce the job requests sent to the same job scheduling agent at the same date
+  void set_message_outbox(std::shared_ptr<MessageOutbox> outbox) { outbox_ = outbox; }
 };
 
 } // namespace wrench
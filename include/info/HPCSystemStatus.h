@@ -8,24 +8,33 @@ class HPCSystemStatus {
   size_t current_num_avaibable_nodes_;
   double current_job_start_time_estimate_;
   size_t queue_length_;
+  size_t num_off_nodes_; // turned off by hardware failures
 
 public:
-  HPCSystemStatus(size_t current_num_avaibable_nodes, double current_job_start_time_estimate, size_t queue_length)
+  HPCSystemStatus(size_t current_num_avaibable_nodes, double current_job_start_time_estimate, size_t queue_length,
+                  size_t num_off_nodes = 0)
       : current_num_avaibable_nodes_(current_num_avaibable_nodes)
       , current_job_start_time_estimate_(current_job_start_time_estimate)
       , queue_length_(queue_length)
+      , num_off_nodes_(num_off_nodes)
   {
   }
 
   size_t get_current_num_avaibable_nodes() const { return current_num_avaibable_nodes_; }
   double get_current_job_start_time_estimate() const { return current_job_start_time_estimate_; }
   size_t get_queue_length() const { return queue_length_; }
+  size_t get_num_off_nodes() const { return num_off_nodes_; }
 
+  // The number of nodes turned off only appears while some are, so that the input of the bidders (and the requests
+  // recorded in bid journals) are those of the runs without hardware failures otherwise
   nlohmann::json to_json() const
   {
-    return {{"current_num_available_nodes", current_num_avaibable_nodes_},
-            {"current_job_start_time_estimate", current_job_start_time_estimate_},
-            {"queue_length", queue_length_}};
+    nlohmann::json j = {{"current_num_available_nodes", current_num_avaibable_nodes_},
+                        {"current_job_start_time_estimate", current_job_start_time_estimate_},
+                        {"queue_length", queue_length_}};
+    if (num_off_nodes_ > 0)
+      j["num_off_nodes"] = num_off_nodes_;
+    return j;
   }
 };
 
@@ -4,6 +4,7 @@
 #include "agents/HeartbeatMonitorAgent.h"
 #include "agents/JobSchedulingAgent.h"
 #include "info/JobDescription.h"
+#include "utils/MessagePool.h"
 #include <wrench-dev.h>
 
 #define CONTROL_MESSAGE_SIZE 0      // Size in bytes
@@ -12,11 +13,12 @@
 namespace wrench {
 
 /// Message to send a job request to a job scheduling agent
-class JobRequestMessage : public ExecutionControllerCustomEventMessage {
+class JobRequestMessage : public ExecutionControllerCustomEventMessage, public PooledMessage<JobRequestMessage> {
   std::shared_ptr<JobDescription> job_description_;
   bool can_forward_;
   bool skip_bidding_;
   std::string bids_;
+  const JobSchedulingAgent* sender_ = nullptr;
 
 public:
   /// @brief
@@ -33,46 +35,106 @@ public:
       , bids_(bids)
   {
   }
+  /// @brief Broadcast of a job, which cannot be forwarded, by the job scheduling agent it was submitted to
+  /// @param job_description job description
+  /// @param sender agent broadcasting the job
+  JobRequestMessage(const std::shared_ptr<JobDescription>& job_description, const JobSchedulingAgent* sender)
+      : JobRequestMessage(job_description, false)
+  {
+    sender_ = sender;
+  }
   bool can_be_forwarded() const { return can_forward_; }
   bool should_skip_bidding() const { return skip_bidding_; }
   const std::shared_ptr<JobDescription>& get_job_description() const { return job_description_; }
   const std::string& get_bids() const { return bids_; }
+  // Only set on broadcasts
+  const JobSchedulingAgent* get_sender() const { return sender_; }
 };
 
 /// Message to send a bid
-class BidOnJobMessage : public ExecutionControllerCustomEventMessage {
+class BidOnJobMessage : public ExecutionControllerCustomEventMessage, public PooledMessage<BidOnJobMessage> {
   const std::shared_ptr<wrench::JobSchedulingAgent> bidder_;
   const std::shared_ptr<JobDescription> job_description_;
   double bid_;
   double tie_breaker_;
+  const JobSchedulingAgent* sender_;
 
 public:
+  /// @param sender agent sending the bid, if not the bidder (bids forwarded up an aggregation tree)
   BidOnJobMessage(const std::shared_ptr<wrench::S4U_Daemon>& bidder,
-                  const std::shared_ptr<JobDescription>& job_description, double bid, double tie_breaker)
+                  const std::shared_ptr<JobDescription>& job_description, double bid, double tie_breaker,
+                  const JobSchedulingAgent* sender = nullptr)
       : ExecutionControllerCustomEventMessage(BROADCAST_MESSAGE_SIZE)
       , bidder_(std::static_pointer_cast<JobSchedulingAgent>(bidder))
       , job_description_(job_description)
       , bid_(bid)
       , tie_breaker_(tie_breaker)
+      , sender_(sender ? sender : bidder_.get())
   {
   }
 
   const std::shared_ptr<JobSchedulingAgent> get_bidder() const { return bidder_; }
+  const JobSchedulingAgent* get_sender() const { return sender_; }
   const std::shared_ptr<JobDescription> get_job_description() const { return job_description_; }
   double get_bid() const { return bid_; }
   double get_tie_breaker() const { return tie_breaker_; }
 };
 
+/// Message to announce the winner of a competitive bidding, when bids are aggregated rather than broadcast
+class BidWinnerMessage : public ExecutionControllerCustomEventMessage, public PooledMessage<BidWinnerMessage> {
+  std::shared_ptr<JobDescription> job_description_;
+  std::string bids_;
+
+public:
+  /// @brief
+  /// @param job_description job description
+  /// @param bids the winning bid, as reported to the job lifecycle tracker
+  BidWinnerMessage(const std::shared_ptr<JobDescription>& job_description, const std::string& bids)
+      : ExecutionControllerCustomEventMessage(CONTROL_MESSAGE_SIZE), job_description_(job_description), bids_(bids)
+  {
+  }
+
+  const std::shared_ptr<JobDescription>& get_job_description() const { return job_description_; }
+  const std::string& get_bids() const { return bids_; }
+};
+
+/// Messages bound for the same agent at the same date, sent as one (see MessageOutbox)
+class CoalescedMessage : public ExecutionControllerCustomEventMessage, public PooledMessage<CoalescedMessage> {
+  std::vector<std::shared_ptr<ExecutionControllerCustomEventMessage>> messages_;
+
+  static double get_total_payload(const std::vector<ExecutionControllerCustomEventMessage*>& messages)
+  {
+    double payload = 0;
+    for (const auto& message : messages)
+      payload += message->payload;
+    return payload;
+  }
+
+public:
+  /// @brief
+  /// @param messages the coalesced messages, in order, of which this message takes ownership
+  explicit CoalescedMessage(const std::vector<ExecutionControllerCustomEventMessage*>& messages)
+      : ExecutionControllerCustomEventMessage(get_total_payload(messages))
+  {
+    messages_.reserve(messages.size());
+    for (auto message : messages)
+      messages_.emplace_back(message);
+  }
+
+  const std::vector<std::shared_ptr<ExecutionControllerCustomEventMessage>>& get_messages() const { return messages_; }
+};
+
 /// Message to send a job lifecycle event notification
 enum class JobLifecycleEventType { SUBMISSION, SCHEDULING, REJECT, START, COMPLETION, FAIL };
 
-class JobLifecycleTrackingMessage : public ExecutionControllerCustomEventMessage {
+class JobLifecycleTrackingMessage : public ExecutionControllerCustomEventMessage,
+                                    public PooledMessage<JobLifecycleTrackingMessage> {
   int job_id_;
   double when_;
-  std::string sent_from_;
+  uint32_t sent_from_; // interned
   JobLifecycleEventType event_type_;
   std::string bids_;
-  std::string failure_cause_;
+  uint32_t failure_cause_; // interned
   std::string node_list_;
 
 public:
@@ -81,37 +143,49 @@ public:
                               const std::string& node_list = "")
       : ExecutionControllerCustomEventMessage(CONTROL_MESSAGE_SIZE)
       , job_id_(job_id)
-      , sent_from_(sender_name)
+      , sent_from_(StringInterner::intern(sender_name))
       , when_(now)
       , event_type_(event_type)
       , bids_(bids)
-      , failure_cause_(failure_cause)
+      , failure_cause_(StringInterner::intern(failure_cause))
       , node_list_(node_list)
   {
   }
   int get_job_id() const { return job_id_; }
   JobLifecycleEventType get_event_type() const { return event_type_; }
   double get_when() const { return when_; }
-  const std::string& get_sender() const { return sent_from_; }
+  const std::string& get_sender() const { return StringInterner::get(sent_from_); }
   const std::string& get_bids() const { return bids_; }
-  const std::string& get_failure_cause() const { return failure_cause_; }
+  const std::string& get_failure_cause() const { return StringInterner::get(failure_cause_); }
   const std::string& get_node_list() const { return node_list_; }
 };
 
-class HeartbeatMessage : public ExecutionControllerCustomEventMessage {
+class HeartbeatMessage : public ExecutionControllerCustomEventMessage, public PooledMessage<HeartbeatMessage> {
   std::shared_ptr<HeartbeatMonitorAgent> sender_;
+  double period_;
 
 public:
-  HeartbeatMessage(const std::shared_ptr<wrench::S4U_Daemon>& sender)
+  /// @param period delay until the next heartbeat of the sender
+  HeartbeatMessage(const std::shared_ptr<wrench::S4U_Daemon>& sender, double period)
       : ExecutionControllerCustomEventMessage(CONTROL_MESSAGE_SIZE)
       , sender_(std::static_pointer_cast<HeartbeatMonitorAgent>(sender))
+      , period_(period)
   {
   }
 
   const std::shared_ptr<HeartbeatMonitorAgent>& get_sender() const { return sender_; }
+  double get_period() const { return period_; }
+};
+
+/// Message from a job scheduling agent to its heartbeat monitor, whose period was stretched, upon new activity
+class HeartbeatResumeMessage : public ExecutionControllerCustomEventMessage,
+                               public PooledMessage<HeartbeatResumeMessage> {
+public:
+  HeartbeatResumeMessage() : ExecutionControllerCustomEventMessage(CONTROL_MESSAGE_SIZE) {}
 };
 
-class HeartbeatFailureNotificationMessage : public ExecutionControllerCustomEventMessage {
+class HeartbeatFailureNotificationMessage : public ExecutionControllerCustomEventMessage,
+                                            public PooledMessage<HeartbeatFailureNotificationMessage> {
   std::shared_ptr<HeartbeatMonitorAgent> failed_agent_;
 
 public:
@@ -123,5 +197,53 @@ public:
   const std::shared_ptr<HeartbeatMonitorAgent>& get_failed_agent() const { return failed_agent_; }
 };
 
+/// Message from a heartbeat monitor to its job scheduling agent, upon hearing again from a member declared failed
+class HeartbeatRecoveryNotificationMessage : public ExecutionControllerCustomEventMessage,
+                                             public PooledMessage<HeartbeatRecoveryNotificationMessage> {
+  std::shared_ptr<HeartbeatMonitorAgent> recovered_agent_;
+
+public:
+  HeartbeatRecoveryNotificationMessage(const std::shared_ptr<HeartbeatMonitorAgent>& recovered_agent)
+      : ExecutionControllerCustomEventMessage(CONTROL_MESSAGE_SIZE), recovered_agent_(recovered_agent)
+  {
+  }
+
+  const std::shared_ptr<HeartbeatMonitorAgent>& get_recovered_agent() const { return recovered_agent_; }
+};
+
+/// Message of the SWIM failure detector (see HeartbeatMonitorAgent)
+class SwimMessage : public ExecutionControllerCustomEventMessage, public PooledMessage<SwimMessage> {
+  SwimMessageType type_;
+  std::shared_ptr<HeartbeatMonitorAgent> sender_;
+  std::shared_ptr<HeartbeatMonitorAgent> subject_;
+  uint64_t probe_id_;
+  std::vector<std::shared_ptr<HeartbeatMonitorAgent>> failed_members_;
+
+public:
+  /// @brief
+  /// @param type type of message
+  /// @param sender the sending monitor
+  /// @param subject the monitor probed
+  /// @param probe_id the probe the message belongs to
+  /// @param failed_members the recently detected failures, piggybacked for dissemination
+  SwimMessage(SwimMessageType type, const std::shared_ptr<HeartbeatMonitorAgent>& sender,
+              const std::shared_ptr<HeartbeatMonitorAgent>& subject, uint64_t probe_id,
+              const std::vector<std::shared_ptr<HeartbeatMonitorAgent>>& failed_members)
+      : ExecutionControllerCustomEventMessage(CONTROL_MESSAGE_SIZE)
+      , type_(type)
+      , sender_(sender)
+      , subject_(subject)
+      , probe_id_(probe_id)
+      , failed_members_(failed_members)
+  {
+  }
+
+  SwimMessageType get_type() const { return type_; }
+  const std::shared_ptr<HeartbeatMonitorAgent>& get_sender() const { return sender_; }
+  const std::shared_ptr<HeartbeatMonitorAgent>& get_subject() const { return subject_; }
+  uint64_t get_probe_id() const { return probe_id_; }
+  const std::vector<std::shared_ptr<HeartbeatMonitorAgent>>& get_failed_members() const { return failed_members_; }
+};
+
 } // namespace wrench
 #endif // CONTROLMESSAGES_H
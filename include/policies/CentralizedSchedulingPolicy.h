@@ -8,7 +8,6 @@
 #include <map>
 #include <memory>
 #include <nlohmann/json.hpp>
-#include <random>
 #include <stdexcept>
 #include <string>
 #include <sys/wait.h>
@@ -22,6 +21,8 @@
 #include "info/HPCSystemDescription.h"
 #include "info/HPCSystemStatus.h"
 #include "info/JobDescription.h"
+#include "utils/BidJournal.h"
+#include "utils/BidderBackend.h"
 #include "utils/utils.h"
 
 XBT_LOG_EXTERNAL_CATEGORY(swarm_dmas);
@@ -41,23 +42,166 @@ struct CentralizedSchedulingDecision {
 
 class CentralizedSchedulingPolicy {
   std::string python_script_name_;
+  // When set, the script implements the batched protocol of CentralizedScheduling.py and is run once per job
+  std::shared_ptr<BidderBackend> batched_bidder_backend_;
+  std::shared_ptr<BidJournal> bid_journal_;
+  bool feasibility_prefilter_  = true;
+  bool bids_zero_on_infeasible_jobs_;
+  size_t num_prefiltered_bids_ = 0;
+
+  // Input of a per-system bidder, also what identifies a bid in the journal
+  static nlohmann::json build_bid_request(const std::shared_ptr<JobDescription>& job_description,
+                                          const HPCSystemInfo& system_info)
+  {
+    nlohmann::json j;
+    j["job_description"]        = job_description->to_json();
+    j["hpc_system_description"] = system_info.description->to_json();
+    j["hpc_system_status"]      = system_info.status->to_json();
+    j["current_simulated_time"] = wrench::S4U_Simulation::getClock();
+    return j;
+  }
+
+  // Record the bid (and its generation time) used for the decision, including the null bids of failed bidders
+  void record_bid(const std::shared_ptr<JobDescription>& job_description, const HPCSystemInfo& system_info, double bid,
+                  double bid_generation_time)
+  {
+    if (bid_journal_)
+      bid_journal_->record(job_description->get_job_id(), system_info.description->get_name(),
+                           BidJournal::hash_input(build_bid_request(job_description, system_info)), bid,
+                           bid_generation_time);
+  }
+
+  static CentralizedSchedulingDecision
+  select_winner(const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids,
+                double decision_time)
+  {
+    auto bids = get_all_bids_as_string(all_bids);
+
+    // Same comparator as SchedulingPolicy::determine_bid_winner
+    auto max_it = std::max_element(all_bids.begin(), all_bids.end(),
+                                   [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    if (max_it->second.first <= 0.0)
+      return {nullptr, decision_time, bids};
+
+    return {max_it->first, decision_time, bids};
+  }
+
+  // Serve the bids recorded in the journal, without running any bidder
+  CentralizedSchedulingDecision
+  select_best_system_replayed(const std::shared_ptr<JobDescription>& job_description,
+                              const std::vector<HPCSystemInfo>& systems_info,
+                              std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>> all_bids)
+  {
+    double decision_time = 0.0;
+    for (const auto& system_info : systems_info) {
+      const auto& sys_name = system_info.description->get_name();
+      auto [bid, bid_generation_time] =
+          bid_journal_->replay(job_description->get_job_id(), sys_name,
+                               BidJournal::hash_input(build_bid_request(job_description, system_info)));
+      decision_time               = std::max(decision_time, bid_generation_time);
+      all_bids[system_info.agent] = {bid, get_tie_breaker(job_description->get_job_id(), sys_name)};
+    }
+    return select_winner(all_bids, decision_time);
+  }
+
+  // Run the script once with all the systems and let it return a bid per system name. The decision time is the longest
+  // per-system bid generation time, i.e., what the per-system protocol measures when bidders run in parallel.
+  CentralizedSchedulingDecision
+  select_best_system_batched(const std::shared_ptr<JobDescription>& job_description,
+                             const std::vector<HPCSystemInfo>& systems_info,
+                             std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>> all_bids)
+  {
+    nlohmann::json j;
+    j["job_description"]        = job_description->to_json();
+    j["systems"]                = nlohmann::json::array();
+    j["current_simulated_time"] = wrench::S4U_Simulation::getClock();
+    for (const auto& system_info : systems_info)
+      j["systems"].push_back({{"system_name", system_info.description->get_name()},
+                              {"description", system_info.description->to_json()},
+                              {"status", system_info.status->to_json()}});
+
+    nlohmann::json result = batched_bidder_backend_->run(j);
+    XBT_CVERB(swarm_dmas, "Centralized bids: %s", result.dump().c_str());
+    if (result.contains("error"))
+      XBT_CWARN(swarm_dmas, "Centralized bidder failed for job #%d: %s", job_description->get_job_id(),
+                result["error"].dump().c_str());
+
+    bool has_bid_generation_times =
+        result.contains("bid_generation_times_seconds") && result["bid_generation_times_seconds"].is_object();
+    double decision_time = 0.0;
+    if (has_bid_generation_times) {
+      for (const auto& [system_name, time] : result["bid_generation_times_seconds"].items())
+        if (time.is_number())
+          decision_time = std::max(decision_time, time.get<double>());
+    } else if (result.contains("decision_time_seconds") && result["decision_time_seconds"].is_number())
+      decision_time = result["decision_time_seconds"].get<double>();
+
+    for (const auto& system_info : systems_info) {
+      const auto& sys_name = system_info.description->get_name();
+      double bid           = 0.0; // a system missing from the answer gets a null bid
+      if (result.contains("bids") && result["bids"].is_object() && result["bids"].contains(sys_name) &&
+          result["bids"][sys_name].is_number())
+        bid = result["bids"][sys_name].get<double>();
+      double bid_generation_time = decision_time;
+      if (has_bid_generation_times && result["bid_generation_times_seconds"].contains(sys_name) &&
+          result["bid_generation_times_seconds"][sys_name].is_number())
+        bid_generation_time = result["bid_generation_times_seconds"][sys_name].get<double>();
+      record_bid(job_description, system_info, bid, bid_generation_time);
+      all_bids[system_info.agent] = {bid, get_tie_breaker(job_description->get_job_id(), sys_name)};
+    }
+
+    return select_winner(all_bids, decision_time);
+  }
 
 public:
-  explicit CentralizedSchedulingPolicy(const std::string& python_script_name) : python_script_name_(python_script_name)
+  explicit CentralizedSchedulingPolicy(const std::string& python_script_name,
+                                       const std::shared_ptr<BidderBackend>& batched_bidder_backend = nullptr,
+                                       const std::shared_ptr<BidJournal>& bid_journal               = nullptr)
+      : python_script_name_(python_script_name)
+      , batched_bidder_backend_(batched_bidder_backend)
+      , bid_journal_(bid_journal)
+      , bids_zero_on_infeasible_jobs_(declares_zero_bids_on_infeasible_jobs(python_script_name))
   {
   }
 
-  // Select the best system for a job by running the bidder script once per system in
-  // parallel — mirroring exactly what the decentralized agents do — and returning the
-  // winner together with the wall-clock duration of the parallel execution (which becomes
-  // the simulated DecisionTime for this job).
+  // Whether the systems on which a job does not pass the acceptance tests bid 0 without running any bidder, provided
+  // the script declares that it bids 0 on them anyway
+  void set_feasibility_prefilter(bool feasibility_prefilter) { feasibility_prefilter_ = feasibility_prefilter; }
+  size_t get_num_prefiltered_bids() const { return num_prefiltered_bids_; }
+
+  // Select the best system for a job. With a batched bidder backend, the script is run once and bids on every system.
+  // Otherwise, the bidder script runs once per system in parallel — mirroring exactly what the decentralized agents
+  // do. In both cases, the winner is returned together with the time the decision took (which becomes the simulated
+  // DecisionTime for this job).
   CentralizedSchedulingDecision
   select_best_system(const std::shared_ptr<JobDescription>& job_description,
-                     const std::vector<HPCSystemInfo>& systems_info)
+                     const std::vector<HPCSystemInfo>& all_systems_info)
   {
-    if (systems_info.empty())
+    if (all_systems_info.empty())
       return {nullptr, 0.0, ""};
 
+    // Systems on which the job does not pass the acceptance tests bid 0, without running (nor replaying) any bidder
+    std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>> all_bids;
+    std::vector<HPCSystemInfo> systems_info;
+    for (const auto& system_info : all_systems_info)
+      if (feasibility_prefilter_ && bids_zero_on_infeasible_jobs_ &&
+          do_not_pass_acceptance_tests(job_description, system_info.description)) {
+        all_bids[system_info.agent] = {0.0, get_tie_breaker(job_description->get_job_id(),
+                                                            system_info.description->get_name())};
+        num_prefiltered_bids_++;
+      } else {
+        systems_info.push_back(system_info);
+      }
+    if (systems_info.empty())
+      return select_winner(all_bids, 0.0);
+
+    if (bid_journal_ && bid_journal_->is_replaying())
+      return select_best_system_replayed(job_description, systems_info, std::move(all_bids));
+
+    if (batched_bidder_backend_)
+      return select_best_system_batched(job_description, systems_info, std::move(all_bids));
+
     if (access(python_script_name_.c_str(), F_OK) != 0)
       throw std::runtime_error("Python script not found: " + python_script_name_);
 
@@ -89,12 +233,7 @@ public:
       close(to_child[0]);
       close(from_child[1]);
 
-      nlohmann::json j;
-      j["job_description"]        = job_description->to_json();
-      j["hpc_system_description"] = systems_info[i].description->to_json();
-      j["hpc_system_status"]      = systems_info[i].status->to_json();
-      j["current_simulated_time"] = wrench::S4U_Simulation::getClock();
-      std::string input = j.dump();
+      std::string input = build_bid_request(job_description, systems_info[i]).dump();
       write(to_child[1], input.c_str(), input.size());
       close(to_child[1]); // signal EOF so the child can start computing
 
@@ -105,9 +244,6 @@ public:
     // Use the Python-reported bid_generation_time_seconds — consistent with the decentralized
     // path which also uses that field — rather than C++ wall-clock time which includes Python
     // interpreter startup overhead (~100 ms) and would distort the simulation clock.
-    std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>> all_bids;
-    constexpr uint64_t SEED  = 42;
-    auto job_id_val           = static_cast<uint64_t>(job_description->get_job_id());
     double decision_time      = 0.0; // max(bid_generation_time_seconds) across all systems
 
     for (int i = 0; i < N; i++) {
@@ -121,7 +257,8 @@ public:
       close(read_fds[i]);
       waitpid(pids[i], nullptr, 0);
 
-      double bid = 0.0;
+      double bid                 = 0.0;
+      double bid_generation_time = 0.0;
       try {
         nlohmann::json result = nlohmann::json::parse(response);
         XBT_CVERB(swarm_dmas, "Centralized bid from %s: %s",
@@ -129,29 +266,17 @@ public:
         if (result.contains("bid") && result["bid"].is_number())
           bid = result["bid"].get<double>();
         if (result.contains("bid_generation_time_seconds") && result["bid_generation_time_seconds"].is_number())
-          decision_time = std::max(decision_time, result["bid_generation_time_seconds"].get<double>());
+          bid_generation_time = result["bid_generation_time_seconds"].get<double>();
       } catch (...) { /* treat parse error as bid = 0, no update to decision_time */ }
+      decision_time = std::max(decision_time, bid_generation_time);
+      record_bid(job_description, systems_info[i], bid, bid_generation_time);
 
-      const auto& sys_name   = systems_info[i].description->get_name();
-      uint64_t mixed         = SEED ^ (job_id_val * 6364136223846793005ULL)
-                                    ^ std::hash<std::string>{}(sys_name);
-      std::mt19937_64 rng(mixed);
-      std::uniform_real_distribution<double> dist(0.0, 100.0);
-      double tie_breaker = dist(rng);
-      all_bids[systems_info[i].agent] = {bid, tie_breaker};
+      const auto& sys_name            = systems_info[i].description->get_name();
+      all_bids[systems_info[i].agent] = {bid, get_tie_breaker(job_description->get_job_id(), sys_name)};
     }
 
     (void)wall_start; // kept in case wall-clock measurement is needed in future
-    auto bids = get_all_bids_as_string(all_bids);
-
-    // Same comparator as PythonBiddingSchedulingPolicy::determine_bid_winner
-    auto max_it = std::max_element(all_bids.begin(), all_bids.end(),
-                                   [](const auto& a, const auto& b) { return a.second < b.second; });
-
-    if (max_it->second.first <= 0.0)
-      return {nullptr, decision_time, bids};
-
-    return {max_it->first, decision_time, bids};
+    return select_winner(all_bids, decision_time);
   }
 };
 
@@ -0,0 +1,25 @@
+#ifndef HEURISTIC_BIDDING_SCHEDULING_POLICY_H
+#define HEURISTIC_BIDDING_SCHEDULING_POLICY_H
+
+#include "policies/SchedulingPolicy.h"
+
+/**
+ * @brief Native port of python_scripts/HeuristicBidding.py.
+ *
+ * The bid combines feasibility checks, a utilization score, a node-fit bonus, a resource compatibility score drawn
+ * (with an md5-seeded jitter) from RESOURCE_COMPATIBILITY_TABLE, a slowdown-based time score with a speed penalty, and
+ * a cross-site data transfer penalty for AI jobs. Bids reproduce those of the Python script bit-for-bit: operations
+ * are evaluated in the same order, the jitter uses a Python-compatible Mersenne Twister, and the final value goes
+ * through Python's round(x, 4). The only possible divergence (one unit in the 4th decimal, on a rounding tie) would
+ * come from a compiler contracting multiply-adds into FMA instructions, which is not the case with default x86-64 flags.
+ */
+class HeuristicBiddingSchedulingPolicy : public SchedulingPolicy {
+public:
+  static double heuristic_bid(const JobDescription& job_description, const HPCSystemDescription& hpc_system_description,
+                              const HPCSystemStatus& hpc_system_status);
+
+  std::pair<double, double> compute_bid(const std::shared_ptr<JobDescription>& job_description,
+                                        const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
+                                        const std::shared_ptr<HPCSystemStatus>& hpc_system_status) override;
+};
+#endif // HEURISTIC_BIDDING_SCHEDULING_POLICY_H
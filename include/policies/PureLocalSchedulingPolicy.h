@@ -7,13 +7,10 @@
 class PureLocalSchedulingPolicy : public SchedulingPolicy {
 
 public:
-  void broadcast_job_description(const std::string& /* agent_name */,
-                                 const std::shared_ptr<JobDescription>& job_description) override
+  void broadcast_job_description(const wrench::JobSchedulingAgent* /* agent */,
+                                 const std::shared_ptr<JobDescription>& /* job_description */) override
   {
-    // Function is only called upon initial submission, hence init the number of needed and received bids only once
-    // Set the number of needed bids to 1
-    set_num_needed_bids(1);
-    init_num_received_bids(job_description->get_job_id());
+    // Jobs are not sent to any other agent: only the local bid is needed (see SchedulingPolicy::get_num_needed_bids)
   }
 
   std::pair<double, double> compute_bid(const std::shared_ptr<JobDescription>& /*job_description*/,
@@ -23,8 +20,11 @@ public:
     return std::make_pair(1.0, 0.0);
   }
 
+  bool is_local_only() const override { return true; }
+
   void broadcast_bid_on_job(const std::shared_ptr<wrench::S4U_Daemon>& bidder,
-                            const std::shared_ptr<JobDescription>& job_description, double bid, double tie_breaker)
+                            const std::shared_ptr<JobDescription>& job_description, double bid,
+                            double tie_breaker) override
   {
     // Just sends a BidOnJobMessage to itself
     bidder->commport->dputMessage(new wrench::BidOnJobMessage(bidder, job_description, bid, tie_breaker));
@@ -6,25 +6,95 @@
 #include <iostream>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <regex>
 #include <stdexcept>
 #include <string>
-#include <sys/wait.h>
-#include <unistd.h>
 #include <xbt/log.h>
 
 #include "agents/JobSchedulingAgent.h"
 #include "messages/ControlMessages.h"
 #include "policies/SchedulingPolicy.h"
+#include "utils/BidJournal.h"
+#include "utils/BidderBackend.h"
+#include "utils/utils.h"
 
 XBT_LOG_EXTERNAL_CATEGORY(swarm_dmas);
 
 class PythonBiddingSchedulingPolicy : public SchedulingPolicy {
   std::string python_script_name_;
   std::string bidder_prompt_;
+  std::shared_ptr<BidderBackend> bidder_backend_;
+  std::shared_ptr<BidJournal> bid_journal_;
+  BidInputs bid_inputs_;
+  bool bids_zero_on_infeasible_jobs_;
+  // Context of the requests on the local HPC system, registered once with the bidder backend (0 if not kept)
+  std::shared_ptr<HPCSystemDescription> context_system_description_;
+  uint32_t context_id_ = 0;
+
+  // A bidder script declares that its bids do not depend on the system status nor on the simulated date with a
+  // top-level BID_INPUTS = "job_and_system" (or "job" if they do not depend on the system either).
+  static BidInputs read_declared_bid_inputs(const std::string& python_script_name)
+  {
+    static const std::regex declaration(R"(^BID_INPUTS\s*=\s*["'](\w+)["'])");
+    std::ifstream script(python_script_name);
+    std::string line;
+    std::smatch match;
+    while (std::getline(script, line))
+      if (std::regex_search(line, match, declaration)) {
+        if (match[1] == "job")
+          return BidInputs::JOB;
+        if (match[1] == "job_and_system")
+          return BidInputs::JOB_AND_SYSTEM;
+        throw std::runtime_error("Invalid BID_INPUTS declaration in " + python_script_name + ": " + match[1].str());
+      }
+    return BidInputs::JOB_SYSTEM_AND_STATUS;
+  }
+
+  // Fields of the requests that do not change from one bid to the next
+  nlohmann::json build_bid_context(const std::shared_ptr<HPCSystemDescription>& hpc_system_description) const
+  {
+    nlohmann::json j;
+    j["hpc_system_description"] = hpc_system_description->to_json();
+    if (!bidder_prompt_.empty())
+      j["prompt"] = bidder_prompt_;
+    return j;
+  }
+
+  nlohmann::json build_bid_request(const std::shared_ptr<JobDescription>& job_description,
+                                   const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
+                                   const std::shared_ptr<HPCSystemStatus>& hpc_system_status,
+                                   bool with_context = true) const
+  {
+    // Serialize input objects to JSON
+    nlohmann::json j = with_context ? build_bid_context(hpc_system_description) : nlohmann::json::object();
+    j["job_description"]        = job_description->to_json();
+    j["hpc_system_status"]      = hpc_system_status->to_json();
+    j["current_simulated_time"] = wrench::S4U_Simulation::getClock();
+    return j;
+  }
+
+  // Only hash what the bids depend on: prefetched bids are computed with a placeholder status
+  static uint64_t hash_bid_request(nlohmann::json j, BidInputs bid_inputs)
+  {
+    if (bid_inputs != BidInputs::JOB_SYSTEM_AND_STATUS) {
+      j.erase("hpc_system_status");
+      j.erase("current_simulated_time");
+    }
+    if (bid_inputs == BidInputs::JOB)
+      j.erase("hpc_system_description");
+    return BidJournal::hash_input(j);
+  }
 
 public:
-  PythonBiddingSchedulingPolicy(const std::string& python_script_name, const std::string& bidder_prompt_file)
-      : SchedulingPolicy(), python_script_name_(python_script_name)
+  PythonBiddingSchedulingPolicy(const std::string& python_script_name, const std::string& bidder_prompt_file,
+                                const std::shared_ptr<BidderBackend>& bidder_backend = nullptr,
+                                const std::shared_ptr<BidJournal>& bid_journal       = nullptr)
+      : SchedulingPolicy()
+      , python_script_name_(python_script_name)
+      , bidder_backend_(bidder_backend ? bidder_backend : std::make_shared<ForkBidderBackend>(python_script_name))
+      , bid_journal_(bid_journal)
+      , bid_inputs_(read_declared_bid_inputs(python_script_name))
+      , bids_zero_on_infeasible_jobs_(declares_zero_bids_on_infeasible_jobs(python_script_name))
   {
     if (!bidder_prompt_file.empty()) {
       std::ifstream prompt_file(bidder_prompt_file);
@@ -37,112 +107,72 @@ public:
     }
   }
 
-  void broadcast_job_description(const std::string& agent_name,
-                                 const std::shared_ptr<JobDescription>& job_description) override
+  void set_hpc_system_description(const std::shared_ptr<HPCSystemDescription>& hpc_system_description) override
   {
-    // The broadcast is only called upon initial submission, we thus init the number of received bids only once.
-    init_num_received_bids(job_description->get_job_id());
-    for (const auto& other_agent : get_job_scheduling_agent_network())
-      if (agent_name != other_agent->getName())
-        other_agent->commport->dputMessage(new wrench::JobRequestMessage(job_description, false));
+    context_system_description_ = hpc_system_description;
+    context_id_                 = bidder_backend_->register_context(build_bid_context(hpc_system_description));
   }
 
   std::pair<double, double> compute_bid(const std::shared_ptr<JobDescription>& job_description,
                                         const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
                                         const std::shared_ptr<HPCSystemStatus>& hpc_system_status) override
   {
-    int to_python[2];   // C++ writes to python
-    int from_python[2]; // C++ reads from python
+    if (bid_journal_ && bid_journal_->is_replaying())
+      return bid_journal_->replay(
+          job_description->get_job_id(), hpc_system_description->get_name(),
+          hash_bid_request(build_bid_request(job_description, hpc_system_description, hpc_system_status), bid_inputs_));
+    return finish_external_bid(job_description, hpc_system_description, hpc_system_status,
+                               start_external_bid(job_description, hpc_system_description, hpc_system_status)());
+  }
 
-    if (pipe(to_python) == -1 || pipe(from_python) == -1) {
-      throw std::runtime_error("Failed to create pipes");
-    }
+  std::function<nlohmann::json()>
+  start_external_bid(const std::shared_ptr<JobDescription>& job_description,
+                     const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
+                     const std::shared_ptr<HPCSystemStatus>& hpc_system_status) override
+  {
+    // Replayed bids are served by compute_bid without running the bidder
+    if (bid_journal_ && bid_journal_->is_replaying())
+      return nullptr;
 
-    if (access(python_script_name_.c_str(), F_OK) != 0)
-      throw std::runtime_error("Python script not found");
-
-    pid_t pid = fork();
-    if (pid == 0) {
-      // External Python process
-      dup2(to_python[0], STDIN_FILENO);    // Read from C++
-      dup2(from_python[1], STDOUT_FILENO); // Write to C++
-
-      close(to_python[1]);
-      close(from_python[0]);
-      close(to_python[0]);
-      close(from_python[1]);
-
-      execlp("python3", "python3", python_script_name_.c_str(), nullptr);
-      perror("execlp failed");
-      exit(1);
-    } else {
-      // C++ process
-      close(to_python[0]);
-      close(from_python[1]);
-
-      // Serialize input objects to JSON
-      nlohmann::json j;
-      j["job_description"]        = job_description->to_json();
-      j["hpc_system_description"] = hpc_system_description->to_json();
-      j["hpc_system_status"]      = hpc_system_status->to_json();
-      j["current_simulated_time"] = wrench::S4U_Simulation::getClock();
-      if (!bidder_prompt_.empty())
-        j["prompt"] = bidder_prompt_;
-
-      std::string jsonStr = j.dump();
-      write(to_python[1], jsonStr.c_str(), jsonStr.size());
-      close(to_python[1]); // Signal EOF to python
-
-      // Read response from python
-      std::string response;
-      char buffer[256];
-      ssize_t count;
-      while ((count = read(from_python[0], buffer, sizeof(buffer) - 1)) > 0) {
-        buffer[count] = '\0';
-        response += buffer;
-      }
-      close(from_python[0]);
-      waitpid(pid, nullptr, 0);
-
-      try {
-        nlohmann::json result = nlohmann::json::parse(response);
-        XBT_CVERB(swarm_dmas, "%s", result.dump().c_str());
-        if (not result.contains("bid_generation_time_seconds") || not result["bid_generation_time_seconds"].is_number())
-          throw std::runtime_error("Invalid response: 'bid_generation_time_seconds' not found or not a number");
-        if (result.contains("bid") && result["bid"].is_number()) {
-          return std::make_pair(result["bid"].get<double>(), result["bid_generation_time_seconds"].get<double>());
-        } else {
-          throw std::runtime_error("Invalid response: 'bid' not found or not a number");
-        }
-      } catch (const std::exception& e) {
-        throw std::runtime_error(std::string("Failed to parse response: ") + e.what());
-      }
+    // Backends are thread-safe: only the bidder itself runs in the returned function
+    if (context_id_ != 0 && hpc_system_description == context_system_description_) {
+      auto j = build_bid_request(job_description, hpc_system_description, hpc_system_status, false);
+      return [backend = bidder_backend_, j = std::move(j), context_id = context_id_]() {
+        return backend->run_in_context(j, context_id);
+      };
     }
+    auto j = build_bid_request(job_description, hpc_system_description, hpc_system_status);
+    return [backend = bidder_backend_, j = std::move(j)]() { return backend->run(j); };
   }
 
-  void broadcast_bid_on_job(const std::shared_ptr<wrench::S4U_Daemon>& bidder,
-                            const std::shared_ptr<JobDescription>& job_description, double bid, double tie_breaker)
+  std::pair<double, double> finish_external_bid(const std::shared_ptr<JobDescription>& job_description,
+                                                const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
+                                                const std::shared_ptr<HPCSystemStatus>& hpc_system_status,
+                                                const nlohmann::json& result) override
   {
-    // Set the number of needed bids to the size of the network of job scheduling agents
-    set_num_needed_bids(get_job_scheduling_agent_network_size());
-    for (const auto& other_agent : get_job_scheduling_agent_network())
-      other_agent->commport->dputMessage(new wrench::BidOnJobMessage(bidder, job_description, bid, tie_breaker));
+    // Workers (and the embedded interpreter) report the failures of the bidder instead of a bid
+    if (result.contains("error"))
+      throw std::runtime_error("Bidder " + python_script_name_ + " failed: " +
+                               (result["error"].is_string() ? result["error"].get<std::string>()
+                                                            : result["error"].dump()));
+    // The response was parsed by the backend, which reports its own parse errors: only its content is checked here
+    XBT_CVERB(swarm_dmas, "%s", result.dump().c_str());
+    if (not result.contains("bid_generation_time_seconds") || not result["bid_generation_time_seconds"].is_number())
+      throw std::runtime_error("Invalid response of bidder " + python_script_name_ +
+                               ": 'bid_generation_time_seconds' not found or not a number");
+    if (not result.contains("bid") || not result["bid"].is_number())
+      throw std::runtime_error("Invalid response of bidder " + python_script_name_ +
+                               ": 'bid' not found or not a number");
+    auto bid = std::make_pair(result["bid"].get<double>(), result["bid_generation_time_seconds"].get<double>());
+    if (bid_journal_)
+      bid_journal_->record(
+          job_description->get_job_id(), hpc_system_description->get_name(),
+          hash_bid_request(build_bid_request(job_description, hpc_system_description, hpc_system_status), bid_inputs_),
+          bid.first, bid.second);
+    return bid;
   }
 
-  std::shared_ptr<wrench::JobSchedulingAgent> determine_bid_winner(
-      const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids) const override
-  {
-    if (all_bids.empty())
-      return nullptr;
-
-    auto max_it = std::max_element(all_bids.begin(), all_bids.end(), [](const auto& a, const auto& b) {
-      if (a.second != b.second)
-        return a.second < b.second; // higher value wins
-      else
-        return a.first < b.first; // tie-breaker: lower pointer address wins
-    });
-
-    return max_it->first;
-  }
+  BidInputs get_bid_inputs() const override { return bid_inputs_; }
+  bool bids_zero_on_infeasible_jobs() const override { return bids_zero_on_infeasible_jobs_; }
 };
 #endif // PYTHON_BIDDING_SCHEDULING_POLICY_H
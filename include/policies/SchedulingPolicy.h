@@ -1,13 +1,23 @@
 #ifndef SCHEDULING_POLICY_H
 #define SCHEDULING_POLICY_H
 
+#include <functional>
 #include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
 #include <vector>
 #include <wrench.h>
 
 #include "info/HPCSystemDescription.h"
 #include "info/HPCSystemStatus.h"
 #include "info/JobDescription.h"
+#include "utils/BidLedger.h"
+#include "utils/MessageOutbox.h"
+
+class BidderBackend;
+class BidJournal;
 
 namespace wrench {
 class JobSchedulingAgent;
@@ -16,16 +26,47 @@ class JobSchedulingAgent;
 class SchedulingPolicy {
   friend class wrench::JobSchedulingAgent;
 
-  size_t num_needed_bids_;
-  std::unordered_map<int, std::unordered_map<std::string, size_t>> num_received_bids_;
+  BidLedger bid_ledger_;
+  std::vector<std::shared_ptr<wrench::JobSchedulingAgent>> job_scheduling_agent_network_;
   std::vector<std::shared_ptr<wrench::JobSchedulingAgent>> healthy_job_scheduling_agent_network_;
   std::vector<std::shared_ptr<wrench::JobSchedulingAgent>> failed_job_scheduling_agent_network_;
 
-protected:
-  void set_num_needed_bids(size_t value) { num_needed_bids_ = value; }
+public:
+  // How the agents exchange their bids on a job. With ALL_TO_ALL, every agent sends its bid to every agent, which all
+  // determine the winner (N^2 messages per job). With TREE, the agents form a k-ary tree, in network order, along which
+  // only the best bid of each subtree goes up to the root, which announces the winner (about 2N messages per job). SITE
+  // is a two-level tree following facility boundaries: the first agent of each site acts as the broker of the site,
+  // runs the auction among the systems of the site, and only forwards the best bid of the site to the top-level auction
+  // among the brokers, run by that of the first site.
+  enum class BidAggregation { ALL_TO_ALL, TREE, SITE };
+
+private:
+  BidAggregation bid_aggregation_ = BidAggregation::ALL_TO_ALL;
+  size_t bid_aggregation_arity_   = 2;
+  // Parent (the root being its own parent), number of children, and height of each healthy agent, by position in the
+  // network. Built upon first use, and again when the network changes.
+  struct AggregationNode {
+    size_t parent;
+    size_t num_children;
+    size_t height;
+  };
+  std::vector<AggregationNode> aggregation_tree_;
+  std::unordered_map<const wrench::JobSchedulingAgent*, size_t> aggregation_positions_;
 
-  void init_num_received_bids(int job_id);
+  bool feasibility_prefilter_      = true;
+  bool exclude_infeasible_bidders_ = false;
 
+  MessageOutbox outbox_;
+  size_t num_bid_messages_           = 0;
+  size_t num_wide_area_bid_messages_ = 0;
+
+  // Position of an agent in the aggregation tree of the healthy agents, if any
+  std::optional<size_t> get_aggregation_position(const wrench::JobSchedulingAgent* agent);
+  void send_bid_message(const wrench::JobSchedulingAgent* sender,
+                        const std::shared_ptr<wrench::JobSchedulingAgent>& receiver,
+                        wrench::ExecutionControllerCustomEventMessage* message);
+
+protected:
   const std::vector<std::shared_ptr<wrench::JobSchedulingAgent>>& get_job_scheduling_agent_network()
   {
     return healthy_job_scheduling_agent_network_;
@@ -33,35 +74,137 @@ protected:
   size_t get_job_scheduling_agent_network_size() const { return healthy_job_scheduling_agent_network_.size(); }
 
   void mark_agent_as_failed(std::shared_ptr<wrench::JobSchedulingAgent> agent);
+  // The agent is back in the healthy network, at its position in the network
+  void mark_agent_as_recovered(const std::shared_ptr<wrench::JobSchedulingAgent>& agent);
+
+  // Send a message to an agent through the outbox of the agent that owns this policy
+  void send_message(const std::shared_ptr<wrench::JobSchedulingAgent>& receiver,
+                    wrench::ExecutionControllerCustomEventMessage* message);
+
+  // Send the local bid of an agent to the network, according to the bid aggregation mode
+  void broadcast_bid_to_network(const std::shared_ptr<wrench::S4U_Daemon>& bidder,
+                                const std::shared_ptr<JobDescription>& job_description, double bid, double tie_breaker);
 
 public:
-  static std::shared_ptr<SchedulingPolicy> create_scheduling_policy(const std::string& policy_name,
-                                                                    const std::string& python_script_name,
-                                                                    const std::string& bidder_prompt_file = "");
+  // What the bids of a policy depend on. Bids that depend neither on the status of the HPC system nor on the simulated
+  // date can be computed ahead of the arrival of a job (see BidPrefetcher).
+  enum class BidInputs { JOB, JOB_AND_SYSTEM, JOB_SYSTEM_AND_STATUS };
+
+  static std::shared_ptr<SchedulingPolicy>
+  create_scheduling_policy(const std::string& policy_name, const std::string& python_script_name,
+                           const std::string& bidder_prompt_file                = "",
+                           const std::shared_ptr<BidderBackend>& bidder_backend = nullptr,
+                           const std::shared_ptr<BidJournal>& bid_journal       = nullptr);
 
   void set_job_scheduling_agent_network(const std::vector<std::shared_ptr<wrench::JobSchedulingAgent>>& network)
   {
+    job_scheduling_agent_network_         = network;
     healthy_job_scheduling_agent_network_ = network;
+    bid_ledger_.set_agents(network);
+    aggregation_tree_.clear();
   }
 
-  virtual void broadcast_job_description(const std::string& agent_name,
-                                         const std::shared_ptr<JobDescription>& job_description)           = 0;
+  // Called once by the job scheduling agent that owns this policy, so that policies can precompute what only depends
+  // on the (static) description of the local HPC system
+  virtual void set_hpc_system_description(const std::shared_ptr<HPCSystemDescription>& /*hpc_system_description*/) {}
+
+  // Send the job to every other healthy agent that takes part in its auction
+  virtual void broadcast_job_description(const wrench::JobSchedulingAgent* agent,
+                                         const std::shared_ptr<JobDescription>& job_description);
   virtual std::pair<double, double> compute_bid(const std::shared_ptr<JobDescription>& job_description,
                                                 const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
                                                 const std::shared_ptr<HPCSystemStatus>& hpc_system_status) = 0;
 
+  // Policies relying on an external bidder can split compute_bid so that the bidder runs outside of the simulation
+  // thread (see BidDispatcher). start_external_bid() is called in the simulation thread and returns the external
+  // computation, which may run in any thread, or an empty function if bids are computed by compute_bid().
+  // finish_external_bid() is called back in the simulation thread with the same arguments and the result.
+  virtual std::function<nlohmann::json()>
+  start_external_bid(const std::shared_ptr<JobDescription>& /*job_description*/,
+                     const std::shared_ptr<HPCSystemDescription>& /*hpc_system_description*/,
+                     const std::shared_ptr<HPCSystemStatus>& /*hpc_system_status*/)
+  {
+    return nullptr;
+  }
+  virtual std::pair<double, double>
+  finish_external_bid(const std::shared_ptr<JobDescription>& /*job_description*/,
+                      const std::shared_ptr<HPCSystemDescription>& /*hpc_system_description*/,
+                      const std::shared_ptr<HPCSystemStatus>& /*hpc_system_status*/, const nlohmann::json& /*result*/)
+  {
+    throw std::logic_error("This scheduling policy does not use an external bidder");
+  }
+  virtual BidInputs get_bid_inputs() const { return BidInputs::JOB_SYSTEM_AND_STATUS; }
+  // Whether the bid of an HPC system on a job that does not pass its acceptance tests is 0, as with the heuristic and
+  // embedding bidders, and the external ones that declare it, so that the feasibility prefilter does not change it
+  virtual bool bids_zero_on_infeasible_jobs() const { return true; }
+  // Whether jobs are only bid on by the agent of the HPC system they were submitted to
+  virtual bool is_local_only() const { return false; }
+
   virtual void broadcast_bid_on_job(const std::shared_ptr<wrench::S4U_Daemon>& bidder,
                                     const std::shared_ptr<JobDescription>& job_description, double bid,
-                                    double tie_breaker) = 0;
+                                    double tie_breaker)
+  {
+    broadcast_bid_to_network(bidder, job_description, bid, tie_breaker);
+  }
 
+  // The highest bid wins, ties being broken by the highest tie breaker, then by the address of the agent
   virtual std::shared_ptr<wrench::JobSchedulingAgent> determine_bid_winner(
-      const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids) const = 0;
+      const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids) const;
+
+  void set_bid_aggregation(BidAggregation bid_aggregation, size_t arity)
+  {
+    bid_aggregation_       = bid_aggregation;
+    bid_aggregation_arity_ = arity;
+  }
+  // Local-only policies (including that of the centralized mode) have no bids to aggregate, whatever the mode set
+  bool is_aggregating_bids() const { return bid_aggregation_ != BidAggregation::ALL_TO_ALL && not is_local_only(); }
+  // With the feasibility prefilter, agents bid 0 on the jobs that do not pass the acceptance tests of their HPC system
+  // without retrieving its status nor running any bidder. With ALL_TO_ALL, infeasible agents can also be excluded from
+  // the auctions: they are neither sent the job nor the bids, and the others record their null bids themselves.
+  void set_feasibility_prefilter(bool feasibility_prefilter, bool exclude_infeasible_bidders)
+  {
+    feasibility_prefilter_      = feasibility_prefilter;
+    exclude_infeasible_bidders_ = feasibility_prefilter && exclude_infeasible_bidders;
+  }
+  bool is_prefiltered_out(const std::shared_ptr<JobDescription>& job_description,
+                          const std::shared_ptr<HPCSystemDescription>& hpc_system_description) const;
+  // The agent of the HPC system a job was submitted to always takes part in its auction
+  bool is_excluded_from_auction(const std::shared_ptr<JobDescription>& job_description,
+                                const std::shared_ptr<wrench::JobSchedulingAgent>& agent) const;
+  // Number of agents whose bid on a job is computed, i.e., not prefiltered out
+  size_t get_num_feasible_bidders(const std::shared_ptr<JobDescription>& job_description);
+  // Called by an agent once it received the bids it needs on a job. Returns true if the best of them was forwarded up
+  // the aggregation tree, false if the agent is to determine the winner.
+  bool forward_best_bid(
+      const wrench::JobSchedulingAgent* agent, const std::shared_ptr<JobDescription>& job_description,
+      const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids);
+  // Called by the root of the aggregation tree, unless it won itself
+  void announce_bid_winner(const wrench::JobSchedulingAgent* agent,
+                           const std::shared_ptr<wrench::JobSchedulingAgent>& winner,
+                           const std::shared_ptr<JobDescription>& job_description, const std::string& bids);
+  const MessageOutbox& get_outbox() const { return outbox_; }
+  // Bid exchange messages between distinct agents, in total and between agents of different sites
+  size_t get_num_bid_messages() const { return num_bid_messages_; }
+  size_t get_num_wide_area_bid_messages() const { return num_wide_area_bid_messages_; }
+  // Number of levels of the aggregation tree below an agent (0 without aggregation), which the auction deadlines of the
+  // agent are scaled by, so that the partial bids of its subtrees reach it before its own deadline
+  size_t get_aggregation_height(const wrench::JobSchedulingAgent* agent);
+  const std::vector<std::shared_ptr<wrench::JobSchedulingAgent>>& get_failed_job_scheduling_agent_network() const
+  {
+    return failed_job_scheduling_agent_network_;
+  }
 
-  size_t get_num_needed_bids() const { return num_needed_bids_; }
-  size_t get_num_received_bids(const std::string& agent_name, int job_id) const
+  // Number of bids an agent needs to decide on a job: those of all the healthy agents, or, with bid aggregation, its
+  // own and the best one of each subtree rooted at one of its children
+  size_t get_num_needed_bids(const wrench::JobSchedulingAgent* agent);
+  // Returns the number of bids received for the job
+  size_t received_bid_for(int job_id, const std::shared_ptr<wrench::JobSchedulingAgent>& bidder, double bid,
+                          double tie_breaker)
   {
-    return num_received_bids_.at(job_id).at(agent_name);
+    return bid_ledger_.record(job_id, bidder, bid, tie_breaker);
   }
-  void received_bid_for(const std::string& agent_name, int job_id) { num_received_bids_[job_id][agent_name] += 1; }
+  const BidLedger& get_bid_ledger() const { return bid_ledger_; }
+  // The scheduling decision has been taken
+  void close_auction(int job_id) { bid_ledger_.close(job_id); }
 };
 #endif // SCHEDULING_POLICY_H
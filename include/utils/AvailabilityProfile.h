@@ -0,0 +1,80 @@
+#ifndef AVAILABILITY_PROFILE_H
+#define AVAILABILITY_PROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Native estimator of job start times, replaying conservative backfilling on the free nodes over time.
+ */
+class AvailabilityProfile {
+  struct Job {
+    size_t num_nodes;
+    double walltime;
+    double start_time; // negative while queued
+  };
+
+  // Step of the profile: free_nodes from date until the date of the next step
+  struct Step {
+    double date;
+    int64_t free_nodes; // negative if running jobs hold more nodes than are on
+    int64_t min_free_nodes;
+    int64_t max_free_nodes;
+    int64_t pending_delta; // not yet applied to the children
+    uint32_t priority;
+    int left  = -1;
+    int right = -1;
+  };
+
+  size_t num_nodes_;
+  size_t num_off_nodes_ = 0; // turned off by hardware failures
+  std::unordered_map<int, Job> jobs_;
+  std::vector<int> queued_jobs_; // in submission order
+  std::vector<Step> steps_;
+  int root_ = -1;
+  std::mt19937 priorities_;
+  bool outdated_ = true;
+
+  size_t num_validated_estimates_ = 0;
+  size_t num_divergent_estimates_ = 0;
+  double max_divergence_          = 0;
+
+  int new_step(double date, int64_t free_nodes);
+  void add(int step, int64_t delta);
+  void push(int step);
+  void pull(int step);
+  void split(int step, double date, int& before, int& from);
+  int merge(int before, int after);
+  void add_step(double date);
+  int64_t get_free_nodes(double date);
+  double find_first_fitting(int step, double from, int64_t num_nodes);
+  double find_first_blocking(int step, double after, double before, int64_t num_nodes);
+
+  void build(double current_simulated_time);
+  double find_earliest_start_time(size_t num_nodes, double walltime, double not_before);
+  void reserve(double start_time, double walltime, size_t num_nodes);
+
+public:
+  explicit AvailabilityProfile(size_t num_nodes) : num_nodes_(num_nodes) {}
+
+  void add_queued_job(int job_id, size_t num_nodes, double walltime);
+  void start_job(int job_id, double start_time);
+  // Upon completion or failure
+  void remove_job(int job_id);
+  // The nodes turned off by hardware failures are not available until they are back on
+  void set_num_off_nodes(size_t num_off_nodes);
+
+  // Earliest date at which a job of num_nodes nodes can run for walltime seconds, or -1 if it does not fit the system
+  double get_start_time_estimate(size_t num_nodes, double walltime, double current_simulated_time);
+
+  // Validation against the estimates of the batch compute service
+  void validate(double start_time_estimate, double batch_start_time_estimate);
+  size_t get_num_validated_estimates() const { return num_validated_estimates_; }
+  size_t get_num_divergent_estimates() const { return num_divergent_estimates_; }
+  double get_max_divergence() const { return max_divergence_; }
+};
+
+#endif // AVAILABILITY_PROFILE_H
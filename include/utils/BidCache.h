@@ -0,0 +1,132 @@
+#ifndef BID_CACHE_H
+#define BID_CACHE_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "info/HPCSystemStatus.h"
+#include "info/JobDescription.h"
+
+/**
+ * @brief Approximate cache of bids, keyed on a quantization of the job and of the status of the HPC system.
+ */
+class BidCache {
+public:
+  using Key = std::tuple<std::string, std::string, std::vector<int64_t>>; // system, job site, buckets
+
+private:
+  struct CachedBid {
+    std::pair<double, double> bid; // bid and decision time
+    size_t num_hits_since_validation;
+  };
+
+  double num_nodes_step_;
+  double walltime_step_;
+  double requested_memory_gb_step_;
+  double requested_storage_gb_step_;
+  double num_available_nodes_step_;
+  double start_time_estimate_step_;
+  double queue_length_step_;
+  double max_bid_error_;
+  size_t revalidation_period_;
+
+  std::map<Key, CachedBid> cached_bids_;
+
+  size_t num_hits_          = 0;
+  size_t num_misses_        = 0;
+  size_t num_revalidations_ = 0;
+  size_t num_violations_    = 0;
+
+  static int64_t quantize(double value, double step)
+  {
+    // Exact values are kept as their bit pattern so that distinct values never share a bucket
+    if (step <= 0) {
+      int64_t bits;
+      static_assert(sizeof(bits) == sizeof(value));
+      std::memcpy(&bits, &value, sizeof(value));
+      return bits;
+    }
+    return static_cast<int64_t>(std::floor(value / step));
+  }
+
+public:
+  explicit BidCache(const nlohmann::json& config)
+      : num_nodes_step_(config.value("num_nodes", 0.0))
+      , walltime_step_(config.value("walltime", 0.0))
+      , requested_memory_gb_step_(config.value("requested_memory_gb", 0.0))
+      , requested_storage_gb_step_(config.value("requested_storage_gb", 0.0))
+      , num_available_nodes_step_(config.value("current_num_available_nodes", 0.0))
+      , start_time_estimate_step_(config.value("current_job_start_time_estimate", 0.0))
+      , queue_length_step_(config.value("queue_length", 0.0))
+      , max_bid_error_(config.value("max_bid_error", std::numeric_limits<double>::infinity()))
+      , revalidation_period_(config.value("revalidation_period", 10))
+  {
+    if (max_bid_error_ < 0)
+      throw std::invalid_argument("Invalid bid cache configuration: max_bid_error must be positive");
+  }
+
+  Key get_key(const std::string& hpc_system_name, const std::shared_ptr<JobDescription>& job_description,
+              const std::shared_ptr<HPCSystemStatus>& hpc_system_status, double current_simulated_time) const
+  {
+    // A negative start time estimate means that the batch system could not compute one
+    auto start_time_estimate = hpc_system_status->get_current_job_start_time_estimate();
+    if (start_time_estimate >= 0)
+      start_time_estimate -= current_simulated_time;
+    return {hpc_system_name,
+            job_description->get_hpc_site(),
+            {static_cast<int64_t>(job_description->get_job_type()), job_description->needs_gpu(),
+             quantize(job_description->get_num_nodes(), num_nodes_step_),
+             quantize(job_description->get_walltime(), walltime_step_),
+             quantize(job_description->get_requested_memory_gb(), requested_memory_gb_step_),
+             quantize(job_description->get_requested_storage_gb(), requested_storage_gb_step_),
+             quantize(hpc_system_status->get_current_num_avaibable_nodes(), num_available_nodes_step_),
+             quantize(start_time_estimate, start_time_estimate_step_),
+             quantize(hpc_system_status->get_queue_length(), queue_length_step_)}};
+  }
+
+  // Returns nothing if the bidder has to be consulted, in which case its bid is expected in store()
+  std::optional<std::pair<double, double>> lookup(const Key& key)
+  {
+    auto it = cached_bids_.find(key);
+    if (it == cached_bids_.end()) {
+      num_misses_++;
+      return std::nullopt;
+    }
+    if (std::isfinite(max_bid_error_) && revalidation_period_ > 0 &&
+        ++it->second.num_hits_since_validation >= revalidation_period_) {
+      num_revalidations_++;
+      return std::nullopt;
+    }
+    num_hits_++;
+    return it->second.bid;
+  }
+
+  void store(const Key& key, const std::pair<double, double>& bid)
+  {
+    auto [it, inserted] = cached_bids_.try_emplace(key, CachedBid{bid, 0});
+    if (inserted)
+      return;
+    if (std::fabs(it->second.bid.first - bid.first) > max_bid_error_)
+      num_violations_++;
+    it->second = {bid, 0};
+  }
+
+  size_t get_num_entries() const { return cached_bids_.size(); }
+  size_t get_num_hits() const { return num_hits_; }
+  size_t get_num_misses() const { return num_misses_; }
+  size_t get_num_revalidations() const { return num_revalidations_; }
+  size_t get_num_violations() const { return num_violations_; }
+};
+
+#endif // BID_CACHE_H
@@ -0,0 +1,60 @@
+#ifndef BID_DISPATCHER_H
+#define BID_DISPATCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A pool of host threads running external bid computations outside of the simulation thread.
+ *
+ * SimGrid runs all the actors in a single thread, so an agent waiting for an external bidder stalls the whole
+ * simulation. A job scheduling agent given a dispatcher hands the external part of its bid computation (see
+ * SchedulingPolicy::start_external_bid) to the pool, yields to the other agents that are ready at the same simulated
+ * date so that they can dispatch their own, and only then waits for its result. The simulation never observes when a
+ * computation completes, only its result, which keeps simulated time and event order deterministic.
+ */
+class BidDispatcher {
+  std::vector<std::thread> threads_;
+  struct BackgroundTask {
+    size_t id;
+    std::packaged_task<nlohmann::json()> task;
+  };
+
+  std::deque<std::packaged_task<nlohmann::json()>> tasks_;
+  std::deque<BackgroundTask> background_tasks_; // only run when no bid is waited for
+  size_t next_background_task_id_ = 0;
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  bool stopping_ = false;
+
+  std::atomic<size_t> num_dispatched_bids_{0};
+
+  void run_tasks();
+
+public:
+  explicit BidDispatcher(size_t num_threads);
+  ~BidDispatcher();
+
+  BidDispatcher(const BidDispatcher&)            = delete;
+  BidDispatcher& operator=(const BidDispatcher&) = delete;
+
+  std::future<nlohmann::json> dispatch(std::function<nlohmann::json()> external_bid);
+  // Background computations (e.g., prefetched bids, see BidPrefetcher) only start when no other bid waits for a thread.
+  // Returns the id of the computation, with which it can be cancelled until it starts.
+  std::pair<size_t, std::future<nlohmann::json>> dispatch_in_background(std::function<nlohmann::json()> external_bid);
+  // Returns true if the background computation had not started yet, and never will
+  bool cancel(size_t background_task_id);
+
+  size_t get_num_threads() const { return threads_.size(); }
+  size_t get_num_dispatched_bids() const { return num_dispatched_bids_; }
+};
+
+#endif // BID_DISPATCHER_H
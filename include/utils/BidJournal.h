@@ -0,0 +1,57 @@
+#ifndef BID_JOURNAL_H
+#define BID_JOURNAL_H
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+
+/**
+ * @brief Record and replay the responses of external bidders.
+ */
+class BidJournal {
+public:
+  enum class Mode { RECORD, REPLAY };
+
+private:
+  struct Entry {
+    uint64_t input_hash;
+    double bid;
+    double bid_generation_time;
+  };
+
+  std::string file_name_;
+  Mode mode_;
+  std::ofstream output_;
+  std::map<std::pair<int, std::string>, std::deque<Entry>> recorded_bids_;
+
+  size_t num_recorded_bids_ = 0;
+  size_t num_replayed_bids_ = 0;
+  size_t num_mismatches_    = 0;
+
+  void load();
+
+public:
+  BidJournal(const std::string& file_name, Mode mode);
+
+  static Mode string_to_mode(const std::string& s);
+
+  // 64-bit FNV-1a hash of the serialized input (object keys are serialized in sorted order)
+  static uint64_t hash_input(const nlohmann::json& input);
+
+  bool is_replaying() const { return mode_ == Mode::REPLAY; }
+
+  void record(int job_id, const std::string& system_name, uint64_t input_hash, double bid,
+              double bid_generation_time);
+  // Throws if no bid was recorded for this job on this system
+  std::pair<double, double> replay(int job_id, const std::string& system_name, uint64_t input_hash);
+
+  size_t get_num_recorded_bids() const { return num_recorded_bids_; }
+  size_t get_num_replayed_bids() const { return num_replayed_bids_; }
+  size_t get_num_mismatches() const { return num_mismatches_; }
+};
+
+#endif // BID_JOURNAL_H
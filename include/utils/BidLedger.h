@@ -0,0 +1,157 @@
+#ifndef BID_LEDGER_H
+#define BID_LEDGER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wrench {
+class JobSchedulingAgent;
+}
+
+/**
+ * @brief Bids received by a job scheduling agent for the jobs whose auction is in flight.
+ */
+class BidLedger {
+public:
+  using Agent = std::shared_ptr<wrench::JobSchedulingAgent>;
+
+private:
+  std::vector<Agent> agents_; // by rank
+  std::unordered_map<const wrench::JobSchedulingAgent*, size_t> ranks_;
+  size_t words_per_slot_ = 0;
+
+  std::unordered_map<int, size_t> open_auctions_; // job id -> slot
+  std::vector<uint64_t> received_;                // slot * words_per_slot_ + rank / 64
+  std::vector<size_t> num_received_;              // slot
+  std::vector<double> bids_;                      // slot * number of agents + rank
+  std::vector<double> tie_breakers_;              // slot * number of agents + rank
+  std::vector<size_t> free_slots_;
+  // Jobs whose auction was closed, by job id (dense in workloads): one bit per job, so that their late bids, whatever
+  // the reason they are late, are not taken for the first bid of a new auction
+  std::vector<bool> closed_;
+
+  size_t get_rank(const Agent& agent) const
+  {
+    auto it = ranks_.find(agent.get());
+    if (it == ranks_.end())
+      throw std::invalid_argument("BidLedger: unknown bidder");
+    return it->second;
+  }
+
+  size_t get_slot(int job_id) const
+  {
+    auto it = open_auctions_.find(job_id);
+    if (it == open_auctions_.end())
+      throw std::invalid_argument("BidLedger: no auction in flight for Job #" + std::to_string(job_id));
+    return it->second;
+  }
+
+  // Auctions are opened by their first bid, so that agents that never receive any do not hold a slot. Does nothing if
+  // the auction is already open.
+  size_t open(int job_id)
+  {
+    auto [it, inserted] = open_auctions_.try_emplace(job_id, 0);
+    if (not inserted)
+      return it->second;
+    if (free_slots_.empty()) {
+      free_slots_.push_back(num_received_.size());
+      received_.resize(received_.size() + words_per_slot_, 0);
+      num_received_.push_back(0);
+      bids_.resize(bids_.size() + agents_.size(), 0);
+      tie_breakers_.resize(tie_breakers_.size() + agents_.size(), 0);
+    }
+    it->second = free_slots_.back();
+    free_slots_.pop_back();
+    return it->second;
+  }
+
+public:
+  void set_agents(const std::vector<Agent>& agents)
+  {
+    if (not open_auctions_.empty())
+      throw std::logic_error("BidLedger: cannot rank agents while auctions are in flight");
+    agents_ = agents;
+    ranks_.clear();
+    for (size_t rank = 0; rank < agents_.size(); rank++)
+      ranks_.emplace(agents_[rank].get(), rank);
+    words_per_slot_ = (agents_.size() + 63) / 64;
+    received_.clear();
+    num_received_.clear();
+    bids_.clear();
+    tie_breakers_.clear();
+    free_slots_.clear();
+  }
+
+  bool is_closed(int job_id) const
+  {
+    return job_id >= 0 && static_cast<size_t>(job_id) < closed_.size() && closed_[job_id];
+  }
+
+  // Returns the number of bids received for the job, 0 if its auction was closed. A second bid from the same bidder is
+  // ignored.
+  size_t record(int job_id, const Agent& bidder, double bid, double tie_breaker)
+  {
+    if (is_closed(job_id))
+      return 0;
+    auto slot  = open(job_id);
+    auto rank  = get_rank(bidder);
+    auto& word = received_[slot * words_per_slot_ + rank / 64];
+    auto bit   = uint64_t{1} << (rank % 64);
+    if (not(word & bit)) {
+      word |= bit;
+      num_received_[slot]++;
+      auto index           = slot * agents_.size() + rank;
+      bids_[index]         = bid;
+      tie_breakers_[index] = tie_breaker;
+    }
+    return num_received_[slot];
+  }
+
+  size_t get_num_received_bids(int job_id) const { return num_received_[get_slot(job_id)]; }
+
+  // Bid and tie breaker of each bidder
+  std::map<Agent, std::pair<double, double>> get_bids(int job_id) const
+  {
+    auto slot = get_slot(job_id);
+    std::map<Agent, std::pair<double, double>> bids;
+    for (size_t word = 0; word < words_per_slot_; word++)
+      for (auto mask = received_[slot * words_per_slot_ + word]; mask; mask &= mask - 1) {
+        auto rank  = word * 64 + __builtin_ctzll(mask);
+        auto index = slot * agents_.size() + rank;
+        bids.try_emplace(agents_[rank], bids_[index], tie_breakers_[index]);
+      }
+    return bids;
+  }
+
+  // Does nothing but remembering the job if no auction is in flight for it
+  void close(int job_id)
+  {
+    if (job_id >= 0) {
+      if (static_cast<size_t>(job_id) >= closed_.size())
+        closed_.resize(job_id + 1);
+      closed_[job_id] = true;
+    }
+    auto it = open_auctions_.find(job_id);
+    if (it == open_auctions_.end())
+      return;
+    auto slot = it->second;
+    std::fill_n(received_.begin() + slot * words_per_slot_, words_per_slot_, 0);
+    num_received_[slot] = 0;
+    free_slots_.push_back(slot);
+    open_auctions_.erase(it);
+  }
+
+  size_t get_num_open_auctions() const { return open_auctions_.size(); }
+  // Number of slots ever allocated, i.e., the largest number of auctions simultaneously in flight
+  size_t get_num_slots() const { return num_received_.size(); }
+};
+
+#endif // BID_LEDGER_H
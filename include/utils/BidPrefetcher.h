@@ -0,0 +1,98 @@
+#ifndef BID_PREFETCHER_H
+#define BID_PREFETCHER_H
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/BidDispatcher.h"
+
+/**
+ * @brief Speculative computation of bids ahead of the simulated arrival of jobs.
+ */
+class BidPrefetcher {
+  struct PrefetchedBid {
+    std::shared_future<nlohmann::json> result;
+    size_t background_task_id;
+    size_t remaining_uses; // a job-only bid is shared by all the agents
+    bool taken = false;
+  };
+
+  std::shared_ptr<BidDispatcher> dispatcher_;
+  size_t lookahead_;
+  std::unordered_map<std::string, PrefetchedBid> prefetched_bids_;
+  std::unordered_map<int, std::vector<std::string>> keys_by_job_;
+
+  size_t num_prefetched_bids_ = 0;
+  size_t num_hits_            = 0;
+  size_t num_misses_          = 0;
+  size_t num_evictions_       = 0;
+  size_t num_cancellations_   = 0;
+
+public:
+  BidPrefetcher(const std::shared_ptr<BidDispatcher>& dispatcher, size_t lookahead)
+      : dispatcher_(dispatcher), lookahead_(lookahead)
+  {
+  }
+
+  // Number of upcoming jobs whose bids are computed ahead of their arrival
+  size_t get_lookahead() const { return lookahead_; }
+
+  bool contains(const std::string& key) const { return prefetched_bids_.find(key) != prefetched_bids_.end(); }
+
+  void prefetch(int job_id, const std::string& key, std::function<nlohmann::json()> external_bid,
+                size_t num_uses = 1)
+  {
+    auto [background_task_id, result] = dispatcher_->dispatch_in_background(std::move(external_bid));
+    prefetched_bids_[key]             = {result.share(), background_task_id, num_uses};
+    keys_by_job_[job_id].push_back(key);
+    num_prefetched_bids_++;
+  }
+
+  std::optional<std::shared_future<nlohmann::json>> take(const std::string& key)
+  {
+    auto it = prefetched_bids_.find(key);
+    if (it == prefetched_bids_.end()) {
+      num_misses_++;
+      return std::nullopt;
+    }
+    num_hits_++;
+    it->second.taken = true;
+    auto result      = it->second.result;
+    if (--it->second.remaining_uses == 0)
+      prefetched_bids_.erase(it);
+    return result;
+  }
+
+  // The auction of a job was decided: the bids prefetched for it that were not taken yet never will be, and those that
+  // nobody waits for are not computed if they have not started yet
+  void evict(int job_id)
+  {
+    auto it = keys_by_job_.find(job_id);
+    if (it == keys_by_job_.end())
+      return;
+    for (const auto& key : it->second) {
+      auto prefetched_bid = prefetched_bids_.find(key);
+      if (prefetched_bid == prefetched_bids_.end())
+        continue;
+      if (not prefetched_bid->second.taken && dispatcher_->cancel(prefetched_bid->second.background_task_id))
+        num_cancellations_++;
+      prefetched_bids_.erase(prefetched_bid);
+      num_evictions_++;
+    }
+    keys_by_job_.erase(it);
+  }
+
+  size_t get_num_prefetched_bids() const { return num_prefetched_bids_; }
+  size_t get_num_hits() const { return num_hits_; }
+  size_t get_num_misses() const { return num_misses_; }
+  size_t get_num_evictions() const { return num_evictions_; }
+  size_t get_num_cancellations() const { return num_cancellations_; }
+};
+
+#endif // BID_PREFETCHER_H
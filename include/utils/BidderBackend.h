@@ -0,0 +1,51 @@
+#ifndef BIDDER_BACKEND_H
+#define BIDDER_BACKEND_H
+
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+
+#include "utils/PythonRunner.h"
+
+/**
+ * @brief Abstract channel to an external bidder.
+ *
+ * A backend receives the JSON document a bidder script expects on its stdin and returns the JSON document the bidder
+ * printed on its stdout. How the bidder is actually run (fresh process, long-lived worker, ...) is up to the backend.
+ */
+class BidderBackend {
+public:
+  virtual ~BidderBackend() = default;
+
+  virtual nlohmann::json run(const nlohmann::json& input) = 0;
+
+  // The fields of the requests of a bidder that do not change from one bid to the next (e.g., the bidder prompt and
+  // the HPC system description) can be registered once as a context. Backends that keep contexts return a non-zero
+  // id, with which requests omitting these fields are then run. Others return 0, and requests have to be complete.
+  virtual uint32_t register_context(const nlohmann::json& /*context*/) { return 0; }
+  virtual nlohmann::json run_in_context(const nlohmann::json& input, uint32_t /*context_id*/) { return run(input); }
+
+  /**
+   * @brief Create a backend from its name in the experiment description.
+   *
+   * @param backend_name "fork" (one python3 process per bid), "pool" (long-lived worker processes), or "embedded"
+   *                     (in-process CPython interpreter).
+   * @param python_script_name Path to the bidder script.
+   * @param pool_size Number of worker processes when backend_name is "pool".
+   */
+  static std::shared_ptr<BidderBackend> create(const std::string& backend_name, const std::string& python_script_name,
+                                               size_t pool_size = 1);
+};
+
+/// Historical behavior: fork and exec a fresh python3 interpreter for every bid.
+class ForkBidderBackend : public BidderBackend {
+  std::string python_script_name_;
+
+public:
+  explicit ForkBidderBackend(const std::string& python_script_name) : python_script_name_(python_script_name) {}
+
+  nlohmann::json run(const nlohmann::json& input) override { return run_python_script(python_script_name_, input); }
+};
+
+#endif // BIDDER_BACKEND_H
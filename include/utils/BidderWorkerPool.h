@@ -0,0 +1,95 @@
+#ifndef BIDDER_WORKER_POOL_H
+#define BIDDER_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+#include "utils/BidderBackend.h"
+
+/**
+ * @brief A pool of long-lived python3 processes running a bidder script.
+ *
+ * Each worker runs python_scripts/bidder_worker.py, which imports the bidder script once and then serves requests on
+ * its stdin/stdout. Bidder scripts written against bidder_template.py are used unmodified, the wrapper feeds each
+ * request to their main() function. A worker that dies (or closes its stdout) is transparently restarted and the
+ * request is retried once.
+ *
+ * Upon start, the pool offers the framed protocol by sending the FRAMED_PROTOCOL line. A worker that answers with the
+ * same line then exchanges length-prefixed frames: a header in host byte order (see FRAME_HEADER_SIZE) followed by a
+ * JSON payload. The contexts registered by the policies (see BidderBackend::register_context: the bidder prompt and
+ * the HPC system description) are serialized once, and sent once per worker session in a CONTEXT frame. Each REQUEST
+ * frame only carries the other fields and the id of its context, which the worker merges back before calling the
+ * bidder. A worker answering anything else is assumed to only speak the line-delimited protocol: one JSON document per
+ * line in, one JSON document per line out, into which contexts are merged back by the pool.
+ */
+class BidderWorkerPool : public BidderBackend {
+public:
+  static constexpr const char* FRAMED_PROTOCOL = "SWARM_DMAS_FRAMED_PROTOCOL 1";
+
+  enum FrameType : uint8_t { CONTEXT = 'C', REQUEST = 'R', RESPONSE = 'A' };
+  // uint32 payload size, uint8 FrameType, uint32 context id (0: no context)
+  static constexpr size_t FRAME_HEADER_SIZE = 9;
+
+private:
+  struct Worker {
+    pid_t pid   = -1;
+    int to_fd   = -1; // C++ writes requests here
+    int from_fd = -1; // C++ reads responses from here
+    bool framed = false;
+    std::set<uint32_t> known_contexts; // contexts already sent to this worker
+    std::string pending_output;
+  };
+
+  std::string python_script_name_;
+  std::string worker_script_name_;
+  std::vector<Worker> workers_;
+  std::vector<size_t> idle_workers_;
+  struct Context {
+    nlohmann::json fields;
+    std::string payload; // serialized fields
+  };
+  std::deque<Context> contexts_; // by id - 1, registered once and for all
+  std::mutex mutex_;
+  std::condition_variable worker_released_;
+
+  std::atomic<size_t> num_requests_{0};
+  std::atomic<size_t> num_restarts_{0};
+  std::atomic<size_t> num_bytes_sent_{0};
+
+  void start_worker(Worker& worker);
+  void stop_worker(Worker& worker);
+  bool send_request(Worker& worker, const std::string& request);
+  bool send_frame(Worker& worker, FrameType type, uint32_t context_id, const std::string& payload);
+  bool read_response(Worker& worker, std::string& response);
+  bool read_frame(Worker& worker, std::string& response);
+  bool exchange(Worker& worker, const nlohmann::json& input, uint32_t context_id, const Context* context,
+                const std::string& request, std::string& response);
+
+  size_t acquire_worker();
+  void release_worker(size_t index);
+
+public:
+  BidderWorkerPool(const std::string& python_script_name, size_t pool_size);
+  ~BidderWorkerPool() override;
+
+  BidderWorkerPool(const BidderWorkerPool&)            = delete;
+  BidderWorkerPool& operator=(const BidderWorkerPool&) = delete;
+
+  nlohmann::json run(const nlohmann::json& input) override;
+  uint32_t register_context(const nlohmann::json& context) override;
+  nlohmann::json run_in_context(const nlohmann::json& input, uint32_t context_id) override;
+
+  size_t get_pool_size() const { return workers_.size(); }
+  size_t get_num_requests() const { return num_requests_; }
+  size_t get_num_restarts() const { return num_restarts_; }
+  size_t get_num_bytes_sent() const { return num_bytes_sent_; }
+};
+
+#endif // BIDDER_WORKER_POOL_H
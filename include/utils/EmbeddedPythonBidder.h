@@ -0,0 +1,31 @@
+#ifndef EMBEDDED_PYTHON_BIDDER_H
+#define EMBEDDED_PYTHON_BIDDER_H
+
+#include <string>
+
+#include "utils/BidderBackend.h"
+
+/**
+ * @brief Run a bidder inside a CPython interpreter embedded in swarm_dmas.
+ *
+ * The bidder script is imported once (per process) and its compute_bid(job, sys, status, now) function is called
+ * directly. Arguments are built as Python dicts from the JSON representations of the descriptions, with no pipe and
+ * no JSON text round-trip. The bid generation time is measured around the call.
+ *
+ * Only bidders that define their own compute_bid function are supported: LLM bidders import compute_bid from
+ * HeuristicBidding as a fallback and must keep using the "fork" or "pool" backends.
+ *
+ * Requires swarm_dmas to be built with ENABLE_EMBEDDED_PYTHON (automatically set when CMake finds the Python3
+ * development files). Otherwise, creating this backend throws.
+ */
+class EmbeddedPythonBidderBackend : public BidderBackend {
+  std::string python_script_name_;
+  void* compute_bid_function_ = nullptr; // borrowed PyObject*, kept alive by the module cache
+
+public:
+  explicit EmbeddedPythonBidderBackend(const std::string& python_script_name);
+
+  nlohmann::json run(const nlohmann::json& input) override;
+};
+
+#endif // EMBEDDED_PYTHON_BIDDER_H
@@ -0,0 +1,110 @@
+#ifndef IDLE_NODE_TRACKER_H
+#define IDLE_NODE_TRACKER_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Incrementally maintained set of the idle compute nodes of an HPC system.
+ */
+class IdleNodeTracker {
+  std::unordered_map<std::string, size_t> node_indices_;
+  std::vector<uint64_t> idle_bitmap_;
+  size_t num_idle_nodes_ = 0;
+  std::vector<uint64_t> off_bitmap_;
+  size_t num_off_nodes_ = 0;
+  std::unordered_map<int, std::vector<size_t>> allocated_nodes_; // per running job
+
+  void set_idle(size_t index, bool idle)
+  {
+    auto& word = idle_bitmap_[index / 64];
+    auto bit   = uint64_t{1} << (index % 64);
+    if (static_cast<bool>(word & bit) == idle)
+      return;
+    word ^= bit;
+    if (idle)
+      num_idle_nodes_++;
+    else
+      num_idle_nodes_--;
+  }
+
+  bool is_off(size_t index) const { return off_bitmap_[index / 64] & (uint64_t{1} << (index % 64)); }
+
+public:
+  // Initialized from the (possibly not all idle) hosts of a batch compute service
+  explicit IdleNodeTracker(const std::map<std::string, unsigned long>& per_host_num_idle_cores)
+      : idle_bitmap_((per_host_num_idle_cores.size() + 63) / 64, 0)
+      , off_bitmap_(idle_bitmap_.size(), 0)
+  {
+    for (const auto& [hostname, idle_cores] : per_host_num_idle_cores) {
+      auto index = node_indices_.size();
+      node_indices_.emplace(hostname, index);
+      set_idle(index, idle_cores > 0);
+    }
+  }
+
+  size_t get_num_idle_nodes() const { return num_idle_nodes_; }
+  size_t get_num_off_nodes() const { return num_off_nodes_; }
+
+  // Jobs running on nodes turned off fail, and release them when their failure is processed
+  void switch_nodes(const std::vector<std::string>& hostnames, bool turn_on)
+  {
+    for (const auto& hostname : hostnames) {
+      auto index = node_indices_.at(hostname);
+      if (is_off(index) != turn_on)
+        continue;
+      off_bitmap_[index / 64] ^= uint64_t{1} << (index % 64);
+      if (turn_on) {
+        num_off_nodes_--;
+        set_idle(index, true);
+      } else {
+        num_off_nodes_++;
+        set_idle(index, false);
+      }
+    }
+  }
+
+  bool is_idle(const std::string& hostname) const
+  {
+    auto index = node_indices_.at(hostname);
+    return idle_bitmap_[index / 64] & (uint64_t{1} << (index % 64));
+  }
+
+  void allocate(int job_id, const std::vector<std::string>& hostnames)
+  {
+    auto& nodes = allocated_nodes_[job_id];
+    for (const auto& hostname : hostnames) {
+      auto index = node_indices_.at(hostname);
+      nodes.push_back(index);
+      set_idle(index, false);
+    }
+  }
+
+  // Does nothing for a job that never started
+  void release(int job_id)
+  {
+    auto it = allocated_nodes_.find(job_id);
+    if (it == allocated_nodes_.end())
+      return;
+    for (auto index : it->second)
+      set_idle(index, not is_off(index));
+    allocated_nodes_.erase(it);
+  }
+
+  // Number of nodes whose state differs from that reported by the batch compute service
+  size_t count_inconsistencies(const std::map<std::string, unsigned long>& per_host_num_idle_cores) const
+  {
+    size_t num_inconsistencies = 0;
+    for (const auto& [hostname, idle_cores] : per_host_num_idle_cores) {
+      auto it = node_indices_.find(hostname);
+      if (it == node_indices_.end() || (not is_off(it->second) && is_idle(hostname) != (idle_cores > 0)))
+        num_inconsistencies++;
+    }
+    return num_inconsistencies;
+  }
+};
+
+#endif // IDLE_NODE_TRACKER_H
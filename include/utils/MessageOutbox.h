@@ -0,0 +1,44 @@
+#ifndef MESSAGE_OUTBOX_H
+#define MESSAGE_OUTBOX_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <wrench-dev.h>
+
+/**
+ * @brief Outgoing control messages of an agent, possibly coalesced per destination.
+ */
+class MessageOutbox {
+  using Message = wrench::ExecutionControllerCustomEventMessage;
+
+  bool coalescing_ = false;
+  std::vector<std::pair<std::shared_ptr<wrench::S4U_Daemon>, std::vector<Message*>>> pending_messages_;
+  std::unordered_map<const wrench::S4U_Daemon*, size_t> destinations_; // index in pending_messages_
+
+  size_t num_messages_      = 0;
+  size_t num_sent_messages_ = 0;
+
+public:
+  MessageOutbox()                                = default;
+  MessageOutbox(const MessageOutbox&)            = delete;
+  MessageOutbox& operator=(const MessageOutbox&) = delete;
+  ~MessageOutbox();
+
+  void set_coalescing(bool coalescing) { coalescing_ = coalescing; }
+  bool is_coalescing() const { return coalescing_; }
+
+  // Takes ownership of the message
+  void send(const std::shared_ptr<wrench::S4U_Daemon>& destination, Message* message);
+  bool empty() const { return pending_messages_.empty(); }
+  // Send the pending messages, one (possibly coalesced) message per destination
+  void flush();
+
+  // Messages handed to the outbox, and messages actually sent
+  size_t get_num_messages() const { return num_messages_; }
+  size_t get_num_sent_messages() const { return num_sent_messages_; }
+};
+
+#endif // MESSAGE_OUTBOX_H
@@ -0,0 +1,85 @@
+#ifndef MESSAGE_POOL_H
+#define MESSAGE_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Allocation counters of the control messages, over all message classes.
+ */
+struct MessagePoolStats {
+  static inline size_t num_allocations      = 0;
+  static inline size_t num_heap_allocations = 0;
+};
+
+/**
+ * @brief Recycling allocator for a class of control messages (see messages/ControlMessages.h).
+ */
+template <typename T>
+class PooledMessage {
+  // Never destroyed, as messages may still be deleted while the simulation is torn down
+  static std::vector<void*>& get_free_blocks()
+  {
+    static auto free_blocks = new std::vector<void*>();
+    return *free_blocks;
+  }
+
+public:
+  static void* operator new(size_t size)
+  {
+    MessagePoolStats::num_allocations++;
+    auto& free_blocks = get_free_blocks();
+    if (size == sizeof(T) && not free_blocks.empty()) {
+      auto block = free_blocks.back();
+      free_blocks.pop_back();
+      return block;
+    }
+    MessagePoolStats::num_heap_allocations++;
+    return ::operator new(size);
+  }
+
+  // Called with the size of the dynamic type, the destructors of messages being virtual
+  static void operator delete(void* block, size_t size)
+  {
+    if (size == sizeof(T))
+      get_free_blocks().push_back(block);
+    else
+      ::operator delete(block);
+  }
+};
+
+/**
+ * @brief Table of the distinct strings carried by control messages, which refer to them by id.
+ */
+class StringInterner {
+  static std::unordered_map<std::string, uint32_t>& get_ids()
+  {
+    static std::unordered_map<std::string, uint32_t> ids;
+    return ids;
+  }
+  static std::deque<std::string>& get_strings()
+  {
+    static std::deque<std::string> strings{""}; // id 0 is the empty string
+    return strings;
+  }
+
+public:
+  static uint32_t intern(const std::string& s)
+  {
+    if (s.empty())
+      return 0;
+    auto [it, inserted] = get_ids().try_emplace(s, static_cast<uint32_t>(get_strings().size()));
+    if (inserted)
+      get_strings().push_back(s);
+    return it->second;
+  }
+
+  static const std::string& get(uint32_t id) { return get_strings()[id]; }
+};
+
+#endif // MESSAGE_POOL_H
@@ -0,0 +1,46 @@
+#ifndef PYTHON_COMPAT_H
+#define PYTHON_COMPAT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * Helpers to reproduce, in native policies, the exact values computed by the Python bidders.
+ */
+
+/// Hexadecimal MD5 digest of a string, as hashlib.md5(s.encode()).hexdigest()
+std::string md5_hex(const std::string& s);
+
+/// int(hashlib.md5(s.encode()).hexdigest()[:8], 16), the seed derivation used by the Python bidders
+uint32_t md5_seed(const std::string& s);
+
+/// round(x, ndigits) with Python semantics (correctly rounded, ties to even on the exact binary value)
+double python_round(double x, int ndigits);
+
+/// str(b) for a Python bool
+inline const char* python_bool(bool b) { return b ? "True" : "False"; }
+
+/**
+ * @brief Mersenne Twister seeded and drawn exactly as Python's random module.
+ *
+ * PythonRandom(seed) matches random.Random(seed) (and random.seed(seed)) for seeds below 2^32, random() returns the
+ * same 53-bit doubles and uniform(a, b) the same values as random.uniform(a, b).
+ */
+class PythonRandom {
+  static constexpr int N = 624;
+  static constexpr int M = 397;
+  std::array<uint32_t, N> state_;
+  int index_ = N + 1;
+
+  void init_genrand(uint32_t s);
+  uint32_t genrand_uint32();
+
+public:
+  explicit PythonRandom(uint32_t seed);
+
+  double random();
+  double uniform(double a, double b) { return a + (b - a) * random(); }
+};
+
+#endif // PYTHON_COMPAT_H
@@ -1,6 +1,8 @@
 #ifndef PYTHON_RUNNER_H
 #define PYTHON_RUNNER_H
 
+#include <cerrno>
+#include <fcntl.h>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <string>
@@ -25,6 +27,10 @@ inline nlohmann::json run_python_script(const std::string& script_path, const nl
 
   if (access(script_path.c_str(), F_OK) != 0)
     throw std::runtime_error("Python script not found: " + script_path);
+  // Bidders may be run concurrently from several threads: a process forked for another bid must not inherit these
+  // pipes, otherwise this bidder would not see EOF on its stdin until that other process exits.
+  for (int fd : {to_python[0], to_python[1], from_python[0], from_python[1]})
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
 
   pid_t pid = fork();
   if (pid == 0) {
@@ -45,18 +51,32 @@ inline nlohmann::json run_python_script(const std::string& script_path, const nl
     close(to_python[0]);
     close(from_python[1]);
 
-    // Send JSON input to Python
+    // Send JSON input to Python. Inputs with a bidder prompt may exceed the capacity of the pipe.
     std::string jsonStr = input.dump();
-    write(to_python[1], jsonStr.c_str(), jsonStr.size());
+    const char* data    = jsonStr.data();
+    size_t remaining    = jsonStr.size();
+    while (remaining > 0) {
+      ssize_t count = write(to_python[1], data, remaining);
+      if (count < 0 && errno == EINTR)
+        continue;
+      if (count <= 0)
+        break; // Python exited early, its output tells why
+      data += count;
+      remaining -= count;
+    }
     close(to_python[1]); // Signal EOF to Python
 
     // Read JSON response from Python
     std::string response;
-    char buffer[256];
+    char buffer[4096];
     ssize_t count;
-    while ((count = read(from_python[0], buffer, sizeof(buffer) - 1)) > 0) {
-      buffer[count] = '\0';
-      response += buffer;
+    while ((count = read(from_python[0], buffer, sizeof(buffer))) != 0) {
+      if (count < 0) {
+        if (errno == EINTR)
+          continue;
+        break;
+      }
+      response.append(buffer, count);
     }
     close(from_python[0]);
     waitpid(pid, nullptr, 0);
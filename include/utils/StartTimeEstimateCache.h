@@ -0,0 +1,69 @@
+#ifndef START_TIME_ESTIMATE_CACHE_H
+#define START_TIME_ESTIMATE_CACHE_H
+
+#include <map>
+#include <optional>
+#include <utility>
+#include <wrench/util/UnitParser.h> //sg_size_t
+
+/**
+ * @brief Start time estimates of the batch compute service of an HPC system, per job shape (num_nodes, walltime).
+ */
+class StartTimeEstimateCache {
+public:
+  using JobShape = std::pair<size_t, sg_size_t>; // num_nodes, walltime
+
+private:
+  struct Estimate {
+    double start_time;
+    double computed_at;
+  };
+
+  std::map<JobShape, Estimate> estimates_;
+
+  size_t num_requests_        = 0;
+  size_t num_hits_            = 0;
+  size_t num_estimator_calls_ = 0;
+  size_t num_invalidations_   = 0;
+
+public:
+  bool contains(const JobShape& job_shape, double current_simulated_time) const
+  {
+    auto it = estimates_.find(job_shape);
+    return it != estimates_.end() &&
+           (it->second.computed_at == current_simulated_time || it->second.start_time > current_simulated_time);
+  }
+
+  std::optional<double> lookup(const JobShape& job_shape, double current_simulated_time)
+  {
+    num_requests_++;
+    if (not contains(job_shape, current_simulated_time))
+      return std::nullopt;
+    num_hits_++;
+    return estimates_.at(job_shape).start_time;
+  }
+
+  // Results of one call to the estimator of the batch compute service, for one or more shapes
+  void store(const std::map<JobShape, double>& start_time_estimates, double current_simulated_time)
+  {
+    num_estimator_calls_++;
+    for (const auto& [job_shape, start_time] : start_time_estimates)
+      estimates_[job_shape] = {start_time, current_simulated_time};
+  }
+
+  // The queue or the set of running jobs changed
+  void invalidate()
+  {
+    if (estimates_.empty())
+      return;
+    estimates_.clear();
+    num_invalidations_++;
+  }
+
+  size_t get_num_requests() const { return num_requests_; }
+  size_t get_num_hits() const { return num_hits_; }
+  size_t get_num_estimator_calls() const { return num_estimator_calls_; }
+  size_t get_num_invalidations() const { return num_invalidations_; }
+};
+
+#endif // START_TIME_ESTIMATE_CACHE_H
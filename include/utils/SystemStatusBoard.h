@@ -0,0 +1,57 @@
+#ifndef SYSTEM_STATUS_BOARD_H
+#define SYSTEM_STATUS_BOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Immutable snapshot of the job-independent part of the status of an HPC system.
+ */
+struct SystemStatusSnapshot {
+  uint64_t version;
+  double publication_date;
+  size_t num_available_nodes;
+  size_t queue_length;
+};
+
+/**
+ * @brief Simulation-wide blackboard of the status of the HPC systems.
+ */
+class SystemStatusBoard {
+  bool strict_;
+  std::unordered_map<std::string, std::shared_ptr<const SystemStatusSnapshot>> snapshots_;
+
+  size_t num_publications_ = 0;
+  size_t num_reads_        = 0;
+
+public:
+  explicit SystemStatusBoard(bool strict) : strict_(strict) {}
+
+  bool is_strict() const { return strict_; }
+
+  const std::shared_ptr<const SystemStatusSnapshot>& publish(const std::string& hpc_system_name, double date,
+                                                             size_t num_available_nodes, size_t queue_length)
+  {
+    auto& snapshot = snapshots_[hpc_system_name];
+    snapshot       = std::make_shared<const SystemStatusSnapshot>(
+        SystemStatusSnapshot{snapshot ? snapshot->version + 1 : 1, date, num_available_nodes, queue_length});
+    num_publications_++;
+    return snapshot;
+  }
+
+  // Returns nothing if nothing was published for this system yet
+  std::shared_ptr<const SystemStatusSnapshot> read(const std::string& hpc_system_name)
+  {
+    num_reads_++;
+    auto it = snapshots_.find(hpc_system_name);
+    return it == snapshots_.end() ? nullptr : it->second;
+  }
+
+  size_t get_num_publications() const { return num_publications_; }
+  size_t get_num_reads() const { return num_reads_; }
+};
+
+#endif // SYSTEM_STATUS_BOARD_H
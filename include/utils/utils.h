@@ -1,7 +1,9 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <map>
 #include <memory>
+#include <set>
 #include <vector>
 #include <wrench-dev.h>
 
@@ -15,9 +17,18 @@ std::shared_ptr<std::vector<std::shared_ptr<JobLifecycle>>> create_job_lifecycle
 size_t get_number_of_available_nodes_on(const std::shared_ptr<wrench::BatchComputeService>& batch);
 double get_job_start_time_estimate_on(const std::shared_ptr<JobDescription>& job_description,
                                       const std::shared_ptr<wrench::BatchComputeService>& batch);
+// Estimates for several job shapes (num_nodes, walltime) in a single call to the estimator of the batch service
+std::map<std::pair<size_t, sg_size_t>, double>
+get_job_start_time_estimates_on(const std::set<std::pair<size_t, sg_size_t>>& job_shapes,
+                                const std::shared_ptr<wrench::BatchComputeService>& batch);
 int do_not_pass_acceptance_tests(const std::shared_ptr<JobDescription>& job_description,
                                  const std::shared_ptr<HPCSystemDescription>& hpc_system_description);
 std::string get_failure_cause_as_string(int failure_code);
+// Whether a bidder script declares a top-level BIDS_ZERO_ON_INFEASIBLE_JOBS = True, i.e., that its bid on a job that
+// does not pass the acceptance tests of an HPC system is 0, so that the feasibility prefilter does not change it
+bool declares_zero_bids_on_infeasible_jobs(const std::string& python_script_name);
+// Tie breaker of the bid of an HPC system on a job, the same wherever it is computed
+double get_tie_breaker(int job_id, const std::string& hpc_system_name);
 std::string get_all_bids_as_string(
     const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids);
 size_t get_queue_length(const std::shared_ptr<wrench::BatchComputeService>& batch);
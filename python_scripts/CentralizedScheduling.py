@@ -5,6 +5,9 @@ import time
 # Reuse the compute_bid function from HeuristicBidding
 from EmbeddingBidding import compute_bid
 
+# Bids 0 on the jobs that do not pass the acceptance tests of a system, which the feasibility prefilter can thus skip
+BIDS_ZERO_ON_INFEASIBLE_JOBS = True
+
 
 def main():
     try:
@@ -17,15 +20,19 @@ def main():
 
         start_time = time.perf_counter()
 
-        # Compute a bid for every system; winner selection is done in C++
-        bids = {
-            s["system_name"]: compute_bid(job_description, s["description"], s["status"], current_simulated_time)
-            for s in systems
-        }
+        # Compute a bid for every system; winner selection is done in C++. Each bid is timed on its own, as a
+        # per-system bidder would report it in bid_generation_time_seconds.
+        bids = {}
+        bid_generation_times = {}
+        for s in systems:
+            bid_start_time = time.perf_counter()
+            bids[s["system_name"]] = compute_bid(job_description, s["description"], s["status"], current_simulated_time)
+            bid_generation_times[s["system_name"]] = round(time.perf_counter() - bid_start_time, 6)
 
         elapsed_time = time.perf_counter() - start_time
 
-        print(json.dumps({"bids": bids, "decision_time_seconds": round(elapsed_time, 6)}))
+        print(json.dumps({"bids": bids, "bid_generation_times_seconds": bid_generation_times,
+                          "decision_time_seconds": round(elapsed_time, 6)}))
     except Exception as e:
         print(json.dumps({"error": str(e), "bids": {}}))
 
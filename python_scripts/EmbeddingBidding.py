@@ -6,6 +6,9 @@ import random
 import hashlib
 import numpy as np
 
+# Bids 0 on the jobs that do not pass the acceptance tests of a system, which the feasibility prefilter can thus skip
+BIDS_ZERO_ON_INFEASIBLE_JOBS = True
+
 JOB_TYPES = ["HPC", "AI", "HYBRID", "STORAGE"]
 SITES = ["NERSC", "ALCF", "OLCF"]
 
@@ -5,6 +5,9 @@ import time
 import random
 import hashlib
 
+# Bids 0 on the jobs that do not pass the acceptance tests of a system, which the feasibility prefilter can thus skip
+BIDS_ZERO_ON_INFEASIBLE_JOBS = True
+
 RESOURCE_COMPATIBILITY_TABLE = {
 
     # ================= HPC JOB =================
@@ -2,6 +2,14 @@ import sys
 import json
 import time
 
+# Uncomment if the bid only depends on the job and system descriptions (not on the system status nor on the current
+# simulated time), so that it can be computed ahead of the arrival of the job (see bid_prefetch_lookahead). Use "job"
+# if the bid does not depend on the system description either.
+# BID_INPUTS = "job_and_system"
+# Uncomment if the bid is 0 on the jobs that do not pass the acceptance tests of the system (GPU, number of nodes,
+# memory, and storage), so that such bids are computed natively without running the bidder (see feasibility_prefilter).
+# BIDS_ZERO_ON_INFEASIBLE_JOBS = True
+
 def main():
     input_data = sys.stdin.read()
     data = json.loads(input_data)
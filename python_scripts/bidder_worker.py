@@ -0,0 +1,134 @@
+"""Long-lived wrapper around a bidder script.
+
+Usage: python3 bidder_worker.py <bidder_script.py>
+
+The bidder script is imported once (so heavy imports such as numpy are paid once per worker) and its main() is then
+called for every request. Each request is handed to the bidder exactly as if it was read from its own stdin, so scripts
+written from bidder_template.py work unmodified.
+
+Requests and responses use a line-delimited protocol: the simulator writes one JSON document per line on stdin, the
+worker answers with one JSON document per line on stdout. If the first line is FRAMED_PROTOCOL, the worker echoes it
+and switches to length-prefixed frames (see BidderWorkerPool.h): a header made of the payload size, the frame type, and
+a context id, followed by a JSON payload. A context frame holds the fields shared by the following requests (e.g., the
+bidder prompt), which are merged back into each request frame referring to it.
+"""
+import importlib.util
+import io
+import json
+import os
+import struct
+import sys
+
+FRAMED_PROTOCOL = b"SWARM_DMAS_FRAMED_PROTOCOL 1"
+FRAME_HEADER = struct.Struct("=IBI")  # payload size, frame type, context id
+CONTEXT_FRAME = ord("C")
+REQUEST_FRAME = ord("R")
+RESPONSE_FRAME = ord("A")
+
+
+def load_bidder(script_path):
+    script_dir = os.path.dirname(os.path.abspath(script_path))
+    # Bidders import each other (e.g., llm_claude_bidder imports HeuristicBidding)
+    if script_dir not in sys.path:
+        sys.path.insert(0, script_dir)
+    module_name = os.path.splitext(os.path.basename(script_path))[0]
+    spec = importlib.util.spec_from_file_location(module_name, script_path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    if not hasattr(module, "main"):
+        raise AttributeError(f"{script_path} does not define a main() function")
+    return module
+
+
+def last_json_line(output):
+    # The bidder prints its result last, anything before is considered as diagnostics
+    for line in reversed(output.splitlines()):
+        line = line.strip()
+        if not line:
+            continue
+        try:
+            return json.loads(line)
+        except ValueError:
+            continue
+    return None
+
+
+def run_bidder(bidder, request):
+    captured = io.StringIO()
+    real_stdin = sys.stdin
+    sys.stdin = io.StringIO(request)
+    sys.stdout = captured
+    try:
+        bidder.main()
+        result = last_json_line(captured.getvalue())
+        if result is None:
+            result = {"error": "bidder produced no JSON output"}
+    except BaseException as e:  # SystemExit included, the worker must survive the bidder
+        if isinstance(e, KeyboardInterrupt):
+            raise
+        result = {"error": f"{type(e).__name__}: {e}"}
+    finally:
+        sys.stdin = real_stdin
+        sys.stdout = sys.__stdout__
+    return json.dumps(result)
+
+
+def serve_lines(bidder, protocol_in, protocol_out, request):
+    while request:
+        if request.strip():
+            protocol_out.write(run_bidder(bidder, request.decode()).encode() + b"\n")
+            protocol_out.flush()
+        request = protocol_in.readline()
+
+
+def read_exactly(protocol_in, size):
+    data = protocol_in.read(size)
+    return data if len(data) == size else None
+
+
+def serve_frames(bidder, protocol_in, protocol_out):
+    contexts = {}  # context id -> JSON object of the shared fields, without its closing brace
+    while True:
+        header = read_exactly(protocol_in, FRAME_HEADER.size)
+        if header is None:
+            break  # The simulator closed the pipe
+        payload_size, frame_type, context_id = FRAME_HEADER.unpack(header)
+        payload = read_exactly(protocol_in, payload_size)
+        if payload is None:
+            break
+        payload = payload.decode()
+
+        if frame_type == CONTEXT_FRAME:
+            contexts[context_id] = payload[:-1]
+            continue
+        if frame_type != REQUEST_FRAME:
+            raise ValueError(f"Unexpected frame type: {frame_type}")
+
+        # Both are JSON objects serialized by the simulator: splice them rather than parsing and serializing again
+        if context_id:
+            payload = contexts[context_id] + ("}" if payload == "{}" else "," + payload[1:])
+        response = run_bidder(bidder, payload).encode()
+        protocol_out.write(FRAME_HEADER.pack(len(response), RESPONSE_FRAME, context_id) + response)
+        protocol_out.flush()
+
+
+def serve(bidder, protocol_in, protocol_out):
+    first_line = protocol_in.readline()
+    if first_line.rstrip(b"\n") == FRAMED_PROTOCOL:
+        protocol_out.write(FRAMED_PROTOCOL + b"\n")
+        protocol_out.flush()
+        serve_frames(bidder, protocol_in, protocol_out)
+    else:
+        serve_lines(bidder, protocol_in, protocol_out, first_line)
+
+
+def main():
+    if len(sys.argv) != 2:
+        print("Usage: bidder_worker.py <bidder_script.py>", file=sys.stderr)
+        sys.exit(1)
+    bidder = load_bidder(sys.argv[1])
+    serve(bidder, sys.stdin.buffer, sys.__stdout__.buffer)
+
+
+if __name__ == "__main__":
+    main()
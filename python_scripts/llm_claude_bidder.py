@@ -22,6 +22,10 @@ MAX_TOKENS = 5000
 TIMEOUT = 30.0 # seconds
 MAX_RETRIES = 0 # no retries
 
+# Bids 0 on the jobs that do not pass the acceptance tests of a system (see is_feasible_system), which the feasibility
+# prefilter can thus skip
+BIDS_ZERO_ON_INFEASIBLE_JOBS = True
+
 # -----------------------------
 # Logging setup
 # -----------------------------
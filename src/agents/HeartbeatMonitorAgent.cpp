@@ -1,14 +1,32 @@
 #include "agents/HeartbeatMonitorAgent.h"
 #include "messages/ControlMessages.h"
 
+#include <algorithm>
+#include <cmath>
+
 WRENCH_LOG_CATEGORY(heartbeat_monitor_agent, "Log category for HeartbeatMonitorAgent");
 
 namespace wrench {
 
+void HeartbeatMonitorAgent::start_period()
+{
+  this->setTimer(S4U_Simulation::getClock() + current_period_, std::to_string(++period_timer_id_));
+}
+
+void HeartbeatMonitorAgent::notify_activity()
+{
+  active_ = true;
+  if (adaptive_period_ && current_period_ > period_) {
+    current_period_ = period_;
+    this->commport->dputMessage(new HeartbeatResumeMessage());
+  }
+}
+
 void HeartbeatMonitorAgent::send_heartbeats()
 {
   for (const auto& agent : heartbeat_monitor_agent_network_) {
-    agent->commport->dputMessage(new HeartbeatMessage(shared_from_this()));
+    agent->commport->dputMessage(new HeartbeatMessage(shared_from_this(), current_period_));
+    num_sent_messages_++;
     WRENCH_DEBUG("Sent heartbeat to %s", agent->getName().c_str());
   }
 }
@@ -17,36 +35,203 @@ void HeartbeatMonitorAgent::check_expired_heartbeats()
 {
   double now = S4U_Simulation::getClock();
   for (const auto& [agent, last_time] : last_heartbeat_time_) {
-    if (now - last_time > expiration_) {
+    // The expiration delay scales with the period announced by the member
+    if (now - last_time > expiration_ * heartbeat_periods_[agent] / period_ && not failed_members_.count(agent)) {
       WRENCH_WARN("Agent %s failed to send heartbeat (last at %.2f)", agent->getName().c_str(), last_time);
-      job_scheduling_agent_->commport->dputMessage(new HeartbeatFailureNotificationMessage(agent));
+      declare_failed(agent);
     }
   }
 }
 
+void HeartbeatMonitorAgent::declare_failed(const std::shared_ptr<HeartbeatMonitorAgent>& member)
+{
+  if (not failed_members_.insert(member).second)
+    return;
+
+  num_detections_++;
+  if (member->get_failure_date() < 0) {
+    num_false_detections_++;
+    WRENCH_WARN("Agent %s declared failed while still alive", member->getName().c_str());
+  } else {
+    auto latency = S4U_Simulation::getClock() - member->get_failure_date();
+    total_detection_latency_ += latency;
+    max_detection_latency_ = std::max(max_detection_latency_, latency);
+    WRENCH_INFO("Agent %s declared failed, %.2f s after its failure", member->getName().c_str(), latency);
+  }
+  job_scheduling_agent_->commport->dputMessage(new HeartbeatFailureNotificationMessage(member));
+
+  // Piggyback the failure on the next O(log N) messages of the failure detector
+  if (failure_detector_ == FailureDetector::SWIM)
+    failure_updates_.emplace_back(
+        member, 3 * static_cast<size_t>(std::ceil(std::log2(heartbeat_monitor_agent_network_.size() + 1))));
+}
+
+void HeartbeatMonitorAgent::record_liveness(const std::shared_ptr<HeartbeatMonitorAgent>& member)
+{
+  if (last_heartbeat_time_.count(member))
+    record_heard_from(member);
+}
+
+void HeartbeatMonitorAgent::record_heard_from(const std::shared_ptr<HeartbeatMonitorAgent>& member)
+{
+  last_heartbeat_time_[member] = S4U_Simulation::getClock();
+  if (not failed_members_.erase(member))
+    return;
+
+  WRENCH_INFO("Agent %s declared alive again", member->getName().c_str());
+  failure_updates_.erase(std::remove_if(failure_updates_.begin(), failure_updates_.end(),
+                                        [&member](const auto& update) { return update.first == member; }),
+                         failure_updates_.end());
+  job_scheduling_agent_->commport->dputMessage(new HeartbeatRecoveryNotificationMessage(member));
+}
+
+void HeartbeatMonitorAgent::send_swim_message(const std::shared_ptr<HeartbeatMonitorAgent>& receiver,
+                                              SwimMessageType type,
+                                              const std::shared_ptr<HeartbeatMonitorAgent>& subject, uint64_t probe_id)
+{
+  std::vector<std::shared_ptr<HeartbeatMonitorAgent>> failed_members;
+  for (auto& [member, num_remaining_messages] : failure_updates_) {
+    failed_members.push_back(member);
+    num_remaining_messages--;
+  }
+  failure_updates_.erase(std::remove_if(failure_updates_.begin(), failure_updates_.end(),
+                                        [](const auto& update) { return update.second == 0; }),
+                         failure_updates_.end());
+  num_sent_messages_++;
+  receiver->commport->dputMessage(new SwimMessage(
+      type, std::static_pointer_cast<HeartbeatMonitorAgent>(shared_from_this()), subject, probe_id, failed_members));
+}
+
+void HeartbeatMonitorAgent::start_probe()
+{
+  // A member that acknowledged neither the direct nor the indirect probes of the previous period has failed
+  if (probed_member_ && not probe_acked_)
+    declare_failed(probed_member_);
+  probed_member_ = nullptr;
+
+  // Next member in the round-robin order, reshuffled at every round, unless it was heard from during the last period
+  auto now      = S4U_Simulation::getClock();
+  auto& members = heartbeat_monitor_agent_network_;
+  for (size_t i = 0; i < members.size() && not probed_member_; i++) {
+    if (next_probe_index_ == 0)
+      std::shuffle(members.begin(), members.end(), rng_);
+    const auto& member = members[next_probe_index_];
+    next_probe_index_  = (next_probe_index_ + 1) % members.size();
+    if (now - last_heartbeat_time_[member] >= current_period_)
+      probed_member_ = member;
+  }
+  if (not probed_member_)
+    return;
+
+  // Probe identifiers are unique across monitors, so that relayed probes can be told apart
+  static uint64_t num_probes = 0;
+  probe_id_                  = ++num_probes;
+  probe_acked_               = false;
+  WRENCH_DEBUG("Probing %s", probed_member_->getName().c_str());
+  send_swim_message(probed_member_, SwimMessageType::PING, probed_member_, probe_id_);
+  // The timer of a probe is ignored once another probe started
+  this->setTimer(now + swim_probe_timeout_, "probe_timeout:" + std::to_string(probe_id_));
+}
+
+void HeartbeatMonitorAgent::probe_indirectly()
+{
+  if (not probed_member_ || probe_acked_)
+    return;
+
+  std::vector<std::shared_ptr<HeartbeatMonitorAgent>> helpers;
+  for (const auto& member : heartbeat_monitor_agent_network_)
+    if (member != probed_member_ && not failed_members_.count(member))
+      helpers.push_back(member);
+  std::shuffle(helpers.begin(), helpers.end(), rng_);
+  helpers.resize(std::min(helpers.size(), swim_fanout_));
+  WRENCH_DEBUG("No acknowledgment from %s, probing it through %zu other members", probed_member_->getName().c_str(),
+               helpers.size());
+  for (const auto& helper : helpers)
+    send_swim_message(helper, SwimMessageType::PING_REQ, probed_member_, probe_id_);
+}
+
+void HeartbeatMonitorAgent::process_swim_message(const std::shared_ptr<SwimMessage>& message)
+{
+  record_heard_from(message->get_sender());
+  // Gossip about a member heard from during the current period is stale
+  auto now = S4U_Simulation::getClock();
+  for (const auto& failed_member : message->get_failed_members())
+    if (failed_member.get() != this && now - last_heartbeat_time_[failed_member] >= current_period_)
+      declare_failed(failed_member);
+
+  switch (message->get_type()) {
+    case SwimMessageType::PING:
+      send_swim_message(message->get_sender(), SwimMessageType::ACK, message->get_subject(), message->get_probe_id());
+      break;
+    case SwimMessageType::PING_REQ:
+      relayed_probes_[message->get_probe_id()] = message->get_sender();
+      send_swim_message(message->get_subject(), SwimMessageType::PING, message->get_subject(),
+                        message->get_probe_id());
+      break;
+    case SwimMessageType::ACK:
+      record_liveness(message->get_subject());
+      if (message->get_probe_id() == probe_id_) {
+        probe_acked_ = true;
+      } else if (auto it = relayed_probes_.find(message->get_probe_id()); it != relayed_probes_.end()) {
+        send_swim_message(it->second, SwimMessageType::ACK, message->get_subject(), message->get_probe_id());
+        relayed_probes_.erase(it);
+      }
+      break;
+  }
+}
+
 int HeartbeatMonitorAgent::main()
 {
   TerminalOutput::setThisProcessLoggingColor(TerminalOutput::COLOR_YELLOW);
-  simgrid::s4u::this_actor::on_exit(
-      [](bool /*failed*/) { WRENCH_DEBUG("My job scheduling agent has been killed! Have to die too!"); });
+  simgrid::s4u::this_actor::on_exit([this](bool /*failed*/) {
+    WRENCH_DEBUG("My job scheduling agent has been killed! Have to die too!");
+    failure_date_ = S4U_Simulation::getClock();
+  });
 
   WRENCH_INFO("Heartbeat Monitor Agent starting");
 
-  this->setTimer(period_, "heartbeat_timer");
+  this->start_period();
 
   while (true) {
     auto event = this->waitForNextEvent();
 
     if (auto timer_event = std::dynamic_pointer_cast<TimerEvent>(event)) {
-      this->send_heartbeats();
-      this->check_expired_heartbeats();
-      this->setTimer(S4U_Simulation::getClock() + period_, "heartbeat_timer");
+      if (timer_event->message.rfind("probe_timeout:", 0) == 0) {
+        if (timer_event->message == "probe_timeout:" + std::to_string(probe_id_))
+          this->probe_indirectly();
+        continue;
+      }
+      if (timer_event->message != std::to_string(period_timer_id_))
+        continue;
+
+      num_periods_++;
+      auto num_detections = num_detections_;
+      if (failure_detector_ == FailureDetector::SWIM)
+        this->start_probe();
+      else
+        this->check_expired_heartbeats();
+      if (adaptive_period_) {
+        if (active_ || num_detections_ > num_detections)
+          current_period_ = period_;
+        else
+          current_period_ = std::min(2 * current_period_, max_period_);
+        active_ = false;
+      }
+      if (failure_detector_ == FailureDetector::HEARTBEAT)
+        this->send_heartbeats();
+      this->start_period();
     }
 
     if (auto hb_event = std::dynamic_pointer_cast<CustomEvent>(event)) {
       if (auto hb_msg = std::dynamic_pointer_cast<HeartbeatMessage>(hb_event->message)) {
-        last_heartbeat_time_[hb_msg->get_sender()] = S4U_Simulation::getClock();
+        heartbeat_periods_[hb_msg->get_sender()] = hb_msg->get_period();
+        this->record_heard_from(hb_msg->get_sender());
         WRENCH_DEBUG("Received heartbeat from %s", hb_msg->get_sender()->getName().c_str());
+      } else if (std::dynamic_pointer_cast<HeartbeatResumeMessage>(hb_event->message)) {
+        // The period snapped back: start a new one right away rather than at the end of the stretched one
+        this->start_period();
+      } else if (auto swim_msg = std::dynamic_pointer_cast<SwimMessage>(hb_event->message)) {
+        this->process_swim_message(swim_msg);
       }
     }
   }
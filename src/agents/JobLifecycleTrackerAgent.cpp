@@ -51,7 +51,8 @@ void JobLifecycleTrackerAgent::processEventCustom(const std::shared_ptr<CustomEv
         WRENCH_INFO("Job #%d has failed", job_id);
         job_lifecycles_->at(pos)->set_end_time(when);
         job_lifecycles_->at(pos)->set_final_status("FAILED");
-        // TODO add set_failure_cause if possible to get it
+        if (not message->get_failure_cause().empty())
+          job_lifecycles_->at(pos)->set_failure_cause(message->get_failure_cause());
         num_failed_jobs_++;
         break;
       default:
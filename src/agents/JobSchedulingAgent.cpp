@@ -2,14 +2,24 @@
 #include "agents/JobLifecycleTrackerAgent.h"
 #include "info/HPCSystemStatus.h"
 #include "messages/ControlMessages.h"
+#include "utils/AvailabilityProfile.h"
+#include "utils/BidCache.h"
+#include "utils/BidDispatcher.h"
+#include "utils/BidPrefetcher.h"
+#include "utils/IdleNodeTracker.h"
+#include "utils/StartTimeEstimateCache.h"
+#include "utils/SystemStatusBoard.h"
 #include "utils/utils.h"
 
+#include <cmath>
 #include <cstdint>
 #include <functional>
 #include <nlohmann/json.hpp>
-#include <random>
+#include <optional>
+#include <simgrid/s4u/Actor.hpp>
 #include <simgrid/s4u/Host.hpp>
 #include <string>
+#include <tuple>
 #include <wrench/services/helper_services/action_execution_service/ActionExecutionService.h>
 
 WRENCH_LOG_CATEGORY(job_scheduling_agent, "Log category for JobSchedulingAgent");
@@ -23,8 +33,22 @@ void JobSchedulingAgent::mark_agent_as_failed(std::shared_ptr<JobSchedulingAgent
 
 void JobSchedulingAgent::processEventCustom(const std::shared_ptr<CustomEvent>& event)
 {
+  // Messages sent to this agent at the same date, by the same agent, processed as if they had been sent one by one
+  if (auto coalesced_message = std::dynamic_pointer_cast<CoalescedMessage>(event->message)) {
+    for (const auto& message : coalesced_message->get_messages())
+      process_message(message);
+  } else {
+    process_message(event->message);
+  }
+}
+
+void JobSchedulingAgent::process_message(const std::shared_ptr<ExecutionControllerCustomEventMessage>& message)
+{
+  if (heartbeat_monitor_)
+    heartbeat_monitor_->notify_activity();
+
   // Receive a Job Request message. It can be an initial submission or a forward.
-  if (auto job_request_message = std::dynamic_pointer_cast<JobRequestMessage>(event->message)) {
+  if (auto job_request_message = std::dynamic_pointer_cast<JobRequestMessage>(message)) {
     const auto& job_description = job_request_message->get_job_description();
     auto job_id                 = job_description->get_job_id();
     WRENCH_DEBUG("Received a job request message for Job #%d: %lu compute nodes for %llu seconds", job_id,
@@ -57,90 +81,458 @@ void JobSchedulingAgent::processEventCustom(const std::shared_ptr<CustomEvent>&
       if (job_request_message->can_be_forwarded()) {
         // This is an initial submission
         // Step 1: Broadcast the JobDescription to the network of Job Scheduling Agents
-        scheduling_policy_->broadcast_job_description(this->getName(), job_description);
+        scheduling_policy_->broadcast_job_description(this, job_description);
+      } else if (heartbeat_monitor_ && job_request_message->get_sender()) {
+        // Job broadcasts piggyback liveness, like bids
+        heartbeat_monitor_->record_liveness(job_request_message->get_sender()->get_heartbeat_monitor());
       }
 
-      // Step 2: Retrieve current state of the HPC_system:
-      // 1) number of available node
-      // 2) an estimate of the start time for this particular job
-      auto current_system_status =
-          std::make_shared<HPCSystemStatus>(get_number_of_available_nodes_on(batch_compute_service_),
-                                            get_job_start_time_estimate_on(job_description, batch_compute_service_),
-                                            get_queue_length(batch_compute_service_));
-
-      // Step 3: Compute a bid for this job description. This bid is based on
-      // 1) The job description
-      // 2) The HPC system description
-      // 3) The current state of the HPC system
-      auto [local_bid, decision_time] =
-          scheduling_policy_->compute_bid(job_description, hpc_system_description_, current_system_status);
+      // Step 2 and 3: Compute a bid for this job description, unless it does not pass the acceptance tests of this HPC
+      // system, in which case the bid is 0 anyway
+      double local_bid;
+      double decision_time;
+      if (scheduling_policy_->is_prefiltered_out(job_description, hpc_system_description_)) {
+        local_bid     = 0.0;
+        decision_time = 0.0;
+        num_prefiltered_bids_++;
+      } else {
+        std::tie(local_bid, decision_time) = compute_local_bid(job_description);
+      }
+      record_excluded_bids(job_description);
       WRENCH_DEBUG("%s computed a bid in %.2f for Job #%d of %.2f", hpc_system_description_->get_cname(), decision_time,
                    job_id, local_bid);
 
-      this->setTimer(S4U_Simulation::getClock() + decision_time,
-                     std::string("{\"job_description\":") + job_description->to_json().dump() + ", \"local_bid\": " +
-                         std::to_string(local_bid) + ", \"compute_time\": " + std::to_string(decision_time) + "}");
+      auto token = next_timer_token_++;
+      pending_bids_.emplace(token, PendingBid{job_description, local_bid, decision_time});
+      this->setTimer(S4U_Simulation::getClock() + decision_time, std::to_string(token));
       // Step 4: Broadcast the local bid to the network of agents will be executed when the timer expires. See
       // :processEventTimer() below
     }
   }
 
   // Receive a bid for a job
-  if (auto bid_on_job_message = std::dynamic_pointer_cast<BidOnJobMessage>(event->message)) {
+  if (auto bid_on_job_message = std::dynamic_pointer_cast<BidOnJobMessage>(message)) {
     auto job_description    = bid_on_job_message->get_job_description();
     auto job_id             = job_description->get_job_id();
     auto remote_bidder      = bid_on_job_message->get_bidder();
     auto remote_bid         = bid_on_job_message->get_bid();
     auto remote_tie_breaker = bid_on_job_message->get_tie_breaker();
 
-    // Increase the number of received bids fot this job
-    scheduling_policy_->received_bid_for(this->getName(), job_id);
-    WRENCH_DEBUG("Received a bid (%lu/%lu) for Job #%d from %s: %.2f (tie breaker: %f)",
-                 scheduling_policy_->get_num_received_bids(this->getName(), job_id),
-                 scheduling_policy_->get_num_needed_bids(), job_id, remote_bidder->get_hpc_system_name().c_str(),
-                 remote_bid, remote_tie_breaker);
-
-    // Store this remote bid
-    all_bids_[job_id].try_emplace(remote_bidder, std::make_pair(remote_bid, remote_tie_breaker));
-
-    if (scheduling_policy_->get_num_received_bids(this->getName(), job_id) ==
-        scheduling_policy_->get_num_needed_bids()) {
-      // All the bids needed to take a decision in the competitive bidding process have been received
-      // Step 5: Determine if this agent won the competitive bidding.
-      if (this->getName() == scheduling_policy_->determine_bid_winner(all_bids_[job_id])->getName()) {
-        if (auto failure_code = do_not_pass_acceptance_tests(job_description, hpc_system_description_)) {
-          WRENCH_DEBUG("Job #%d did not pass acceptance and has failed. Notifying the Job Lifecycle Tracker Agent",
-                       job_id);
-          tracker_->commport->dputMessage(new JobLifecycleTrackingMessage(
-              job_id, hpc_system_description_->get_name(), wrench::S4U_Simulation::getClock(),
-              JobLifecycleEventType::REJECT, get_all_bids_as_string(all_bids_[job_id]),
-              get_failure_cause_as_string(failure_code)));
-        } else {
-          WRENCH_DEBUG("Schedule Job #%d (%lu compute nodes for %llu seconds) on '%s'", job_id,
-                       job_description->get_num_nodes(), job_description->get_walltime(),
-                       hpc_system_description_->get_cname());
-          tracker_->commport->dputMessage(new JobLifecycleTrackingMessage(
-              job_id, hpc_system_description_->get_name(), wrench::S4U_Simulation::getClock(),
-              JobLifecycleEventType::SCHEDULING, get_all_bids_as_string(all_bids_[job_id])));
-
-          build_and_submit_job(job_id, job_description);
-        }
-      } // if this agent did not win, just proceed.
-      // Bids are not needed anymore for this job: a scheduling decision has been taken by one of the agents, and the
-      // values of the bids have been sent to the job lifecycle tracker.
-      all_bids_.erase(job_id);
-    } // More bids need to be received
+    // Bids double as liveness evidence for the failure detector
+    if (heartbeat_monitor_)
+      heartbeat_monitor_->record_liveness(bid_on_job_message->get_sender()->get_heartbeat_monitor());
+
+    // Late bids on a job this agent already decided on, including those of the auctions closed early on a deadline or
+    // upon a failure, would open a new auction
+    if (scheduling_policy_->get_bid_ledger().is_closed(job_id)) {
+      WRENCH_DEBUG("Ignoring the bid of %s for the decided Job #%d", remote_bidder->get_hpc_system_name().c_str(),
+                   job_id);
+      return;
+    }
+    if (not runs_auction_of(job_description))
+      return;
+    // The number of needed bids is set once and for all upon the first bid, whoever sent it
+    auto [auction, inserted] =
+        auctions_.try_emplace(job_id, Auction{job_description, scheduling_policy_->get_num_needed_bids(this)});
+    if (inserted && auction_deadline_ > 0) {
+      auto token = next_timer_token_++;
+      auction_deadlines_.emplace(token, job_id);
+      this->setTimer(S4U_Simulation::getClock() +
+                         auction_deadline_ * (1 + scheduling_policy_->get_aggregation_height(this)),
+                     std::to_string(token));
+    }
+
+    // Store this remote bid and increase the number of received bids for this job
+    auto num_received_bids =
+        scheduling_policy_->received_bid_for(job_id, remote_bidder, remote_bid, remote_tie_breaker);
+    WRENCH_DEBUG("Received a bid (%lu/%lu) for Job #%d from %s: %.2f (tie breaker: %f)", num_received_bids,
+                 auction->second.num_needed_bids, job_id, remote_bidder->get_hpc_system_name().c_str(), remote_bid,
+                 remote_tie_breaker);
+
+    // More bids than needed are received once the number of needed bids was lowered upon a failure
+    if (num_received_bids >= auction->second.num_needed_bids || auction->second.past_deadline)
+      evaluate_auction(job_id);
   }
 
+  // Receive the announcement that this agent won the competitive bidding on a job
+  if (auto bid_winner_message = std::dynamic_pointer_cast<BidWinnerMessage>(message))
+    schedule_won_job(bid_winner_message->get_job_description(), bid_winner_message->get_bids());
+
   // Receive a heartbeat failure notification
-  if (auto heartbeat_failure_message = std::dynamic_pointer_cast<HeartbeatFailureNotificationMessage>(event->message)) {
-    auto failed_agent = heartbeat_failure_message->get_failed_agent();
+  if (auto heartbeat_failure_message = std::dynamic_pointer_cast<HeartbeatFailureNotificationMessage>(message)) {
+    const auto& failed_agent = heartbeat_failure_message->get_failed_agent()->get_job_scheduling_agent();
+    WRENCH_INFO("%s has failed", failed_agent->get_hpc_system_name().c_str());
+    mark_agent_as_failed(failed_agent);
+
+    // Its bids on the jobs in flight may never come: decide on those for which the bids of the others suffice. Those
+    // past their deadline are closed as soon as they reach their quorum.
+    std::vector<int> job_ids;
+    for (auto& [job_id, auction] : auctions_) {
+      auction.num_needed_bids = std::min(auction.num_needed_bids, scheduling_policy_->get_num_needed_bids(this));
+      if (not auction.past_deadline)
+        job_ids.push_back(job_id);
+    }
+    for (auto job_id : job_ids)
+      if (evaluate_auction(job_id))
+        num_auctions_closed_on_failure_++;
+  }
+
+  // Receive the notification that an agent declared failed was heard from again, e.g., once a link outage is over. It
+  // is sent the bids of this agent again, and its own count again.
+  if (auto heartbeat_recovery_message = std::dynamic_pointer_cast<HeartbeatRecoveryNotificationMessage>(message)) {
+    const auto& recovered_agent = heartbeat_recovery_message->get_recovered_agent()->get_job_scheduling_agent();
+    WRENCH_INFO("%s has recovered", recovered_agent->get_hpc_system_name().c_str());
+    scheduling_policy_->mark_agent_as_recovered(recovered_agent);
+  }
+}
+
+bool JobSchedulingAgent::runs_auction_of(const std::shared_ptr<JobDescription>& job_description) const
+{
+  return auction_deadline_ <= 0 || scheduling_policy_->is_aggregating_bids() ||
+         job_description->get_hpc_system() == hpc_system_description_->get_name();
+}
+
+bool JobSchedulingAgent::evaluate_auction(int job_id)
+{
+  auto& auction = auctions_.at(job_id);
+  auto all_bids = scheduling_policy_->get_bid_ledger().get_bids(job_id);
+  // Failed agents can neither win nor send the bids still missing
+  for (const auto& failed_agent : scheduling_policy_->get_failed_job_scheduling_agent_network())
+    all_bids.erase(failed_agent);
+
+  auto num_needed_bids = auction.num_needed_bids;
+  if (all_bids.size() < num_needed_bids) {
+    auto quorum = std::max<size_t>(1, std::ceil(auction_quorum_ * num_needed_bids));
+    if (not auction.past_deadline || all_bids.size() < quorum)
+      return false;
+    WRENCH_INFO("Closing the auction of Job #%d on its deadline with %zu/%zu bids", job_id, all_bids.size(),
+                num_needed_bids);
+    num_auctions_closed_on_deadline_++;
   }
+  decide_auction(auction.job_description, all_bids);
+  // Bids are not needed anymore for this job: a scheduling decision has been taken by one of the agents, and the
+  // values of the bids have been sent to the job lifecycle tracker.
+  scheduling_policy_->close_auction(job_id);
+  auctions_.erase(job_id);
+  return true;
+}
+
+void JobSchedulingAgent::decide_auction(
+    const std::shared_ptr<JobDescription>& job_description,
+    const std::map<std::shared_ptr<JobSchedulingAgent>, std::pair<double, double>>& all_bids)
+{
+  // Unless the bids only are those of a subtree of agents, whose best one goes up the aggregation tree
+  if (scheduling_policy_->forward_best_bid(this, job_description, all_bids))
+    return;
+  // All the bids are known from here on, and the prefetched ones that were not taken will never be
+  if (bid_prefetcher_)
+    bid_prefetcher_->evict(job_description->get_job_id());
+
+  // Step 5: Determine if this agent won the competitive bidding.
+  auto winner = scheduling_policy_->determine_bid_winner(all_bids);
+  if (scheduling_policy_->is_aggregating_bids()) {
+    // Only the winning bid is known
+    auto bids = get_all_bids_as_string({{winner, all_bids.at(winner)}});
+    if (this->getName() == winner->getName())
+      schedule_won_job(job_description, bids);
+    else
+      scheduling_policy_->announce_bid_winner(this, winner, job_description, bids);
+  } else if (this->getName() == winner->getName()) {
+    schedule_won_job(job_description, get_all_bids_as_string(all_bids));
+  } else if (job_description->get_hpc_system() == hpc_system_description_->get_name() &&
+             (auction_deadline_ > 0 || scheduling_policy_->is_excluded_from_auction(job_description, winner))) {
+    // Either this agent alone runs the auction (see runs_auction_of()), or all the bids were null and that of an agent
+    // that never heard of the job won, which it has to reject
+    scheduling_policy_->announce_bid_winner(this, winner, job_description, get_all_bids_as_string(all_bids));
+  } // if this agent did not win, just proceed.
+}
+
+void JobSchedulingAgent::schedule_won_job(const std::shared_ptr<JobDescription>& job_description,
+                                          const std::string& bids)
+{
+  auto job_id = job_description->get_job_id();
+  if (auto failure_code = do_not_pass_acceptance_tests(job_description, hpc_system_description_)) {
+    WRENCH_DEBUG("Job #%d did not pass acceptance and has failed. Notifying the Job Lifecycle Tracker Agent", job_id);
+    tracker_->commport->dputMessage(new JobLifecycleTrackingMessage(job_id, hpc_system_description_->get_name(),
+                                                                    wrench::S4U_Simulation::getClock(),
+                                                                    JobLifecycleEventType::REJECT, bids,
+                                                                    get_failure_cause_as_string(failure_code)));
+  } else {
+    WRENCH_DEBUG("Schedule Job #%d (%lu compute nodes for %llu seconds) on '%s'", job_id,
+                 job_description->get_num_nodes(), job_description->get_walltime(),
+                 hpc_system_description_->get_cname());
+    tracker_->commport->dputMessage(new JobLifecycleTrackingMessage(job_id, hpc_system_description_->get_name(),
+                                                                    wrench::S4U_Simulation::getClock(),
+                                                                    JobLifecycleEventType::SCHEDULING, bids));
+
+    build_and_submit_job(job_id, job_description);
+  }
+}
+
+std::pair<double, double> JobSchedulingAgent::compute_local_bid(const std::shared_ptr<JobDescription>& job_description)
+{
+  // Step 2: Retrieve current state of the HPC_system:
+  // 1) number of available node
+  // 2) an estimate of the start time for this particular job
+  auto status_snapshot       = get_status_snapshot();
+  auto current_system_status = std::make_shared<HPCSystemStatus>(
+      status_snapshot->num_available_nodes, get_job_start_time_estimate(job_description),
+      status_snapshot->queue_length, get_num_off_nodes());
+
+  // Step 3: Compute a bid for this job description. This bid is based on
+  // 1) The job description
+  // 2) The HPC system description
+  // 3) The current state of the HPC system
+  std::optional<std::shared_future<nlohmann::json>> prefetched_bid;
+  if (bid_prefetcher_ && scheduling_policy_->get_bid_inputs() != SchedulingPolicy::BidInputs::JOB_SYSTEM_AND_STATUS)
+    prefetched_bid = bid_prefetcher_->take(get_bid_prefetch_key(job_description));
+  // Prefetched bids are exact and already paid for, only look for an approximate one otherwise
+  std::optional<BidCache::Key> bid_cache_key;
+  std::optional<std::pair<double, double>> cached_bid;
+  if (bid_cache_ && not prefetched_bid) {
+    bid_cache_key = bid_cache_->get_key(hpc_system_description_->get_name(), job_description, current_system_status,
+                                        S4U_Simulation::getClock());
+    cached_bid    = bid_cache_->lookup(*bid_cache_key);
+  }
+  std::function<nlohmann::json()> external_bid;
+  if (bid_dispatcher_ && not prefetched_bid && not cached_bid)
+    external_bid =
+        scheduling_policy_->start_external_bid(job_description, hpc_system_description_, current_system_status);
+  double local_bid;
+  double decision_time;
+  if (cached_bid) {
+    // A near-identical job was bid on in a near-identical status of this system
+    std::tie(local_bid, decision_time) = *cached_bid;
+  } else if (prefetched_bid) {
+    // Computed ahead of the arrival of the job, possibly still running in the background
+    std::tie(local_bid, decision_time) = scheduling_policy_->finish_external_bid(
+        job_description, hpc_system_description_, current_system_status, prefetched_bid->get());
+  } else if (external_bid) {
+    // Run the external bidder in the thread pool and let the other agents ready at this date start their own
+    // before waiting for it. Only the result of the bidder matters to the simulation, not when it comes back.
+    auto pending_bid = bid_dispatcher_->dispatch(std::move(external_bid));
+    simgrid::s4u::this_actor::yield();
+    std::tie(local_bid, decision_time) = scheduling_policy_->finish_external_bid(
+        job_description, hpc_system_description_, current_system_status, pending_bid.get());
+  } else {
+    std::tie(local_bid, decision_time) =
+        scheduling_policy_->compute_bid(job_description, hpc_system_description_, current_system_status);
+  }
+  if (bid_cache_key && not cached_bid)
+    bid_cache_->store(*bid_cache_key, {local_bid, decision_time});
+  return {local_bid, decision_time};
+}
+
+void JobSchedulingAgent::record_excluded_bids(const std::shared_ptr<JobDescription>& job_description)
+{
+  // The agents excluded from the auction would have bid 0, with the same tie breaker wherever it is computed
+  if (not runs_auction_of(job_description))
+    return;
+  auto job_id = job_description->get_job_id();
+  for (const auto& agent : scheduling_policy_->get_job_scheduling_agent_network())
+    if (scheduling_policy_->is_excluded_from_auction(job_description, agent)) {
+      scheduling_policy_->received_bid_for(job_id, agent, 0.0, get_tie_breaker(job_id, agent->get_hpc_system_name()));
+      if (job_description->get_hpc_system() == hpc_system_description_->get_name())
+        num_excluded_bidders_++;
+    }
+}
+
+std::string JobSchedulingAgent::get_bid_prefetch_key(const std::shared_ptr<JobDescription>& job_description) const
+{
+  // A job-only bid is the same for every agent and thus prefetched once
+  if (scheduling_policy_->get_bid_inputs() == SchedulingPolicy::BidInputs::JOB)
+    return std::to_string(job_description->get_job_id());
+  return std::to_string(job_description->get_job_id()) + "@" + hpc_system_description_->get_name();
+}
+
+void JobSchedulingAgent::prefetch_bid(const std::shared_ptr<JobDescription>& job_description)
+{
+  auto bid_inputs = scheduling_policy_->get_bid_inputs();
+  if (not bid_prefetcher_ || bid_inputs == SchedulingPolicy::BidInputs::JOB_SYSTEM_AND_STATUS)
+    return;
+
+  // Bids that the feasibility prefilter computes natively are never taken
+  if (scheduling_policy_->is_prefiltered_out(job_description, hpc_system_description_))
+    return;
+  auto key = get_bid_prefetch_key(job_description);
+  if (bid_prefetcher_->contains(key))
+    return;
+
+  // The bidder declared not using the status of the system, any value would do
+  auto unused_system_status = std::make_shared<HPCSystemStatus>(0, job_description->get_submission_time(), 0);
+  auto external_bid =
+      scheduling_policy_->start_external_bid(job_description, hpc_system_description_, unused_system_status);
+  if (not external_bid)
+    return;
+
+  auto num_uses = (bid_inputs == SchedulingPolicy::BidInputs::JOB)
+                      ? scheduling_policy_->get_num_feasible_bidders(job_description)
+                      : 1;
+  WRENCH_DEBUG("Prefetching the bid of %s for Job #%d", hpc_system_description_->get_cname(),
+               job_description->get_job_id());
+  bid_prefetcher_->prefetch(job_description->get_job_id(), key, std::move(external_bid), num_uses);
+}
+
+const std::shared_ptr<IdleNodeTracker>& JobSchedulingAgent::get_idle_node_tracker()
+{
+  // Built upon first use, once the batch compute service is up. The only full scan of its hosts.
+  if (not idle_node_tracker_)
+    idle_node_tracker_ = std::make_shared<IdleNodeTracker>(batch_compute_service_->getPerHostNumIdleCores(false));
+  return idle_node_tracker_;
+}
+
+size_t JobSchedulingAgent::get_num_off_nodes()
+{
+  return get_idle_node_tracker()->get_num_off_nodes();
+}
+
+size_t JobSchedulingAgent::get_number_of_available_nodes()
+{
+  const auto& tracker = get_idle_node_tracker();
+  if (check_idle_nodes_) {
+    auto num_inconsistencies = tracker->count_inconsistencies(batch_compute_service_->getPerHostNumIdleCores(false));
+    if (num_inconsistencies > 0) {
+      WRENCH_WARN("%zu node(s) of '%s' are not in the state reported by its batch compute service (%zu idle nodes "
+                  "instead of %zu)",
+                  num_inconsistencies, hpc_system_description_->get_cname(), tracker->get_num_idle_nodes(),
+                  get_number_of_available_nodes_on(batch_compute_service_));
+      num_idle_node_inconsistencies_ += num_inconsistencies;
+    }
+  }
+  return tracker->get_num_idle_nodes();
+}
+
+void JobSchedulingAgent::on_job_queued(int job_id, const std::shared_ptr<JobDescription>& job_description)
+{
+  if (availability_profile_)
+    availability_profile_->add_queued_job(job_id, job_description->get_num_nodes(), job_description->get_walltime());
+  on_status_change();
+}
+
+void JobSchedulingAgent::on_job_started(int job_id, double start_time, const std::vector<std::string>& hostnames)
+{
+  get_idle_node_tracker()->allocate(job_id, hostnames);
+  if (availability_profile_)
+    availability_profile_->start_job(job_id, start_time);
+  on_status_change();
+}
+
+void JobSchedulingAgent::on_job_ended(int job_id)
+{
+  get_idle_node_tracker()->release(job_id);
+  if (availability_profile_)
+    availability_profile_->remove_job(job_id);
+  on_status_change();
+}
+
+void JobSchedulingAgent::on_status_change()
+{
+  // The queue or the set of running jobs changed
+  if (heartbeat_monitor_)
+    heartbeat_monitor_->notify_activity();
+  if (start_time_estimate_cache_)
+    start_time_estimate_cache_->invalidate();
+  if (status_board_ && not status_board_->is_strict())
+    status_board_->publish(hpc_system_description_->get_name(), S4U_Simulation::getClock(),
+                           get_number_of_available_nodes(), get_queue_length(batch_compute_service_));
+}
+
+std::shared_ptr<const SystemStatusSnapshot> JobSchedulingAgent::get_status_snapshot()
+{
+  if (not status_board_)
+    return std::make_shared<const SystemStatusSnapshot>(SystemStatusSnapshot{
+        0, S4U_Simulation::getClock(), get_number_of_available_nodes(), get_queue_length(batch_compute_service_)});
+  // Fresh from the batch compute service
+  if (status_board_->is_strict())
+    return status_board_->publish(hpc_system_description_->get_name(), S4U_Simulation::getClock(),
+                                  get_number_of_available_nodes_on(batch_compute_service_),
+                                  get_queue_length(batch_compute_service_));
+  if (auto snapshot = status_board_->read(hpc_system_description_->get_name()))
+    return snapshot;
+  // Nothing changed on this system yet
+  return status_board_->publish(hpc_system_description_->get_name(), S4U_Simulation::getClock(),
+                                get_number_of_available_nodes(), get_queue_length(batch_compute_service_));
+}
+
+std::map<std::pair<size_t, sg_size_t>, double>
+JobSchedulingAgent::get_batch_start_time_estimates(const std::set<std::pair<size_t, sg_size_t>>& job_shapes)
+{
+  // The batch compute service ignores that nodes are off and counts on them. At least, the jobs that do not fit on the
+  // nodes still on cannot start before some are back on, which is reported as for the jobs that do not fit (-1).
+  auto start_time_estimates = get_job_start_time_estimates_on(job_shapes, batch_compute_service_);
+  auto num_off_nodes        = get_num_off_nodes();
+  if (num_off_nodes > 0)
+    for (auto& [job_shape, start_time_estimate] : start_time_estimates)
+      if (job_shape.first > hpc_system_description_->get_num_nodes() - num_off_nodes)
+        start_time_estimate = -1;
+  return start_time_estimates;
+}
+
+std::map<std::pair<size_t, sg_size_t>, double>
+JobSchedulingAgent::compute_start_time_estimates(const std::set<std::pair<size_t, sg_size_t>>& job_shapes)
+{
+  if (not availability_profile_)
+    return get_batch_start_time_estimates(job_shapes);
+
+  auto now = S4U_Simulation::getClock();
+  std::map<std::pair<size_t, sg_size_t>, double> start_time_estimates;
+  for (const auto& [num_nodes, walltime] : job_shapes)
+    start_time_estimates[{num_nodes, walltime}] =
+        availability_profile_->get_start_time_estimate(num_nodes, walltime, now);
+
+  if (validate_start_time_estimates_)
+    for (const auto& [job_shape, batch_estimate] : get_batch_start_time_estimates(job_shapes)) {
+      auto estimate = start_time_estimates.at(job_shape);
+      availability_profile_->validate(estimate, batch_estimate);
+      if (std::fabs(estimate - batch_estimate) > 1e-6)
+        WRENCH_DEBUG("Start time estimate of %lu nodes for %llu seconds on '%s': %f with the availability profile, %f "
+                     "with the batch compute service",
+                     job_shape.first, job_shape.second, hpc_system_description_->get_cname(), estimate,
+                     batch_estimate);
+    }
+  return start_time_estimates;
+}
+
+double JobSchedulingAgent::get_job_start_time_estimate(const std::shared_ptr<JobDescription>& job_description)
+{
+  StartTimeEstimateCache::JobShape job_shape = {job_description->get_num_nodes(), job_description->get_walltime()};
+  if (not start_time_estimate_cache_)
+    return compute_start_time_estimates({job_shape}).at(job_shape);
+
+  auto now = S4U_Simulation::getClock();
+  if (auto start_time_estimate = start_time_estimate_cache_->lookup(job_shape, now))
+    return *start_time_estimate;
+  auto start_time_estimates = compute_start_time_estimates({job_shape});
+  start_time_estimate_cache_->store(start_time_estimates, now);
+  return start_time_estimates.at(job_shape);
+}
+
+void JobSchedulingAgent::estimate_job_start_times(
+    const std::vector<std::shared_ptr<JobDescription>>& job_descriptions)
+{
+  if (not start_time_estimate_cache_)
+    return;
+
+  auto now = S4U_Simulation::getClock();
+  std::set<StartTimeEstimateCache::JobShape> job_shapes;
+  for (const auto& job_description : job_descriptions) {
+    if (scheduling_policy_->is_local_only() && job_description->get_hpc_system() != hpc_system_description_->get_name())
+      continue; // This agent will never see this job
+    if (scheduling_policy_->is_prefiltered_out(job_description, hpc_system_description_))
+      continue; // Nor estimate its start time
+    StartTimeEstimateCache::JobShape job_shape = {job_description->get_num_nodes(), job_description->get_walltime()};
+    if (not start_time_estimate_cache_->contains(job_shape, now))
+      job_shapes.insert(job_shape);
+  }
+  if (not job_shapes.empty())
+    start_time_estimate_cache_->store(compute_start_time_estimates(job_shapes), now);
 }
 
 void JobSchedulingAgent::processEventCompoundJobCompletion(const std::shared_ptr<CompoundJobCompletedEvent>& event)
 {
   auto job_id = std::stoi(event->job->getName());
+  on_job_ended(job_id);
+  submitted_jobs_.erase(job_id);
   WRENCH_DEBUG("Job #%d, which I ran locally, has completed. Notifying the Job Lifecycle Tracker Agent", job_id);
   tracker_->commport->dputMessage(new JobLifecycleTrackingMessage(job_id, hpc_system_description_->get_name(),
                                                                   wrench::S4U_Simulation::getClock(),
@@ -149,14 +541,23 @@ void JobSchedulingAgent::processEventCompoundJobCompletion(const std::shared_ptr
 
 void JobSchedulingAgent::build_and_submit_job(int job_id, const std::shared_ptr<JobDescription>& job_description)
 {
-  auto job        = job_manager_->createCompoundJob(std::to_string(job_id));
+  // Requeued jobs get a distinct name, still starting with their id
+  auto num_requeues = submitted_jobs_.try_emplace(job_id, SubmittedJob{job_description}).first->second.num_requeues;
+  auto job          = job_manager_->createCompoundJob(
+      num_requeues ? std::to_string(job_id) + "." + std::to_string(num_requeues) : std::to_string(job_id));
   // Capture actual start time for later use in the logging action
-  auto start_time = std::make_shared<double>(-1.0);
-  auto tracking   = job->addCustomAction("", 0, 0,
-                                         [start_time](const std::shared_ptr<ActionExecutor>&) {
-                                           *start_time = wrench::S4U_Simulation::getClock();
-                                         },
-                                         {[](const std::shared_ptr<ActionExecutor>&) {}});
+  auto start_time   = std::make_shared<double>(-1.0);
+  // and account for the nodes allocated to the job
+  auto tracking     = job->addCustomAction(
+      "", 0, 0,
+      [this, job_id, start_time](const std::shared_ptr<ActionExecutor>& executor) {
+        *start_time = wrench::S4U_Simulation::getClock();
+        std::vector<std::string> hostnames;
+        for (const auto& kv : executor->getActionExecutionService()->getComputeResources())
+          hostnames.push_back(kv.first->get_name());
+        on_job_started(job_id, *start_time, hostnames);
+      },
+      {[](const std::shared_ptr<ActionExecutor>&) {}});
   auto scaling_factor = this->getHost()->get_speed() / 1.5e12;
   if (hpc_system_description_->has_gpu())
     scaling_factor = std::min(7.5, scaling_factor / 10);
@@ -204,36 +605,77 @@ void JobSchedulingAgent::build_and_submit_job(int job_id, const std::shared_ptr<
                                        {"-t", std::to_string(job_description->get_walltime())},
                                        {"-c", "1"}};
   job_manager_->submitJob(job, batch_compute_service_, job_args);
+  on_job_queued(job_id, job_description);
 }
 
 void JobSchedulingAgent::processEventCompoundJobFailure(const std::shared_ptr<CompoundJobFailedEvent>& event)
 {
   auto job_id = std::stoi(event->job->getName());
+  on_job_ended(job_id);
+
+  // Resubmit the jobs hit by a hardware failure, if they fit on the compute nodes that are still on. The failure of the
+  // job itself only reports that some of its actions failed: the host error is the failure cause of those.
+  bool hit_by_hardware_failure = std::dynamic_pointer_cast<HostError>(event->failure_cause) != nullptr;
+  for (const auto& action : event->job->getActions())
+    if (std::dynamic_pointer_cast<HostError>(action->getFailureCause()))
+      hit_by_hardware_failure = true;
+  auto it = submitted_jobs_.find(job_id);
+  if (hit_by_hardware_failure && it != submitted_jobs_.end() &&
+      it->second.num_requeues < max_job_requeues_ &&
+      it->second.job_description->get_num_nodes() <=
+          hpc_system_description_->get_num_nodes() - get_idle_node_tracker()->get_num_off_nodes()) {
+    it->second.num_requeues++;
+    num_requeued_jobs_++;
+    WRENCH_INFO("Job #%d failed on '%s' because of a hardware failure: requeuing it (%zu/%zu)", job_id,
+                hpc_system_description_->get_cname(), it->second.num_requeues, max_job_requeues_);
+    build_and_submit_job(job_id, it->second.job_description);
+    return;
+  }
+  if (it != submitted_jobs_.end())
+    submitted_jobs_.erase(it);
+
   WRENCH_DEBUG("Job #%d, which I'm running locally, has failed. Notifying the Job Lifecycle Tracker Agent", job_id);
   tracker_->commport->dputMessage(new JobLifecycleTrackingMessage(
-      job_id, hpc_system_description_->get_name(), wrench::S4U_Simulation::getClock(), JobLifecycleEventType::FAIL));
+      job_id, hpc_system_description_->get_name(), wrench::S4U_Simulation::getClock(), JobLifecycleEventType::FAIL,
+      "", event->failure_cause ? event->failure_cause->toString() : ""));
+}
+
+void JobSchedulingAgent::on_compute_nodes_switched(const std::vector<std::string>& hostnames, bool turn_on)
+{
+  get_idle_node_tracker()->switch_nodes(hostnames, turn_on);
+  if (availability_profile_)
+    availability_profile_->set_num_off_nodes(get_num_off_nodes());
+  WRENCH_INFO("%zu compute nodes of '%s' turned %s (%zu off)", hostnames.size(), hpc_system_description_->get_cname(),
+              turn_on ? "back on" : "off", get_idle_node_tracker()->get_num_off_nodes());
+  on_status_change();
 }
 
 void JobSchedulingAgent::processEventTimer(const std::shared_ptr<wrench::TimerEvent>& event)
 {
-  auto mesg = event->toString();
-  // Skip "TimerEvent (message: " (21 characters) and remove last ')'
-  std::string json_str = mesg.substr(21, mesg.length() - 22);
-  // Parse the JSON
-  nlohmann::json j = nlohmann::json::parse(json_str);
+  auto token = std::stoull(event->message);
+  if (auto deadline = auction_deadlines_.find(token); deadline != auction_deadlines_.end()) {
+    auto job_id = deadline->second;
+    auction_deadlines_.erase(deadline);
+    // Unless the auction was already decided
+    if (auto auction = auctions_.find(job_id); auction != auctions_.end()) {
+      auction->second.past_deadline = true;
+      evaluate_auction(job_id);
+    }
+    return;
+  }
+
+  auto it = pending_bids_.find(token);
+  if (it == pending_bids_.end())
+    throw std::runtime_error("JobSchedulingAgent::processEventTimer(): unknown timer " + event->message);
+  auto pending_bid = std::move(it->second);
+  pending_bids_.erase(it);
 
   // Step 4: Broadcast the local bid to the network of agents
 
-  constexpr uint64_t SEED = 42;
-  auto job_id_val         = static_cast<uint64_t>(j["job_description"]["job_id"].get<int>());
-  uint64_t mixed          = SEED ^ (job_id_val * 6364136223846793005ULL)
-                                 ^ std::hash<std::string>{}(hpc_system_description_->get_name());
-  std::mt19937_64 gen(mixed);
-  std::uniform_real_distribution<double> dis(0.0, 100.0);
-  auto tie_breaker = dis(gen);
+  auto tie_breaker = get_tie_breaker(pending_bid.job_description->get_job_id(), hpc_system_description_->get_name());
 
-  scheduling_policy_->broadcast_bid_on_job(shared_from_this(), std::make_shared<JobDescription>(j["job_description"]),
-                                           j["local_bid"], tie_breaker);
+  scheduling_policy_->broadcast_bid_on_job(shared_from_this(), pending_bid.job_description, pending_bid.bid,
+                                           tie_breaker);
 }
 
 int JobSchedulingAgent::main()
@@ -242,15 +684,25 @@ int JobSchedulingAgent::main()
   WRENCH_INFO("Job Scheduling Agent starting");
   simgrid::s4u::this_actor::on_exit([this](bool /*failed*/) {
     WRENCH_DEBUG("I have been killed! kill my HeartbeatMonitorAgent too!");
-    heartbeat_monitor_->killActor();
+    if (heartbeat_monitor_)
+      heartbeat_monitor_->killActor();
   });
 
   // Create my job manager
   job_manager_ = this->createJobManager();
 
   // Just waits for events to happen
-  while (true)
+  auto& outbox = scheduling_policy_->outbox_;
+  while (true) {
     this->waitForAndProcessNextEvent();
+    // Keep processing the events of the current date, if any, before sending the messages coalesced meanwhile
+    if (outbox.is_coalescing()) {
+      bool processed = true;
+      while (processed && not outbox.empty())
+        processed = this->waitForAndProcessNextEvent(0);
+      outbox.flush();
+    }
+  }
 }
 
 } // namespace wrench
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <random>
 
+#include "agents/JobSchedulingAgent.h"
 #include "agents/ResourceSwitchingAgent.h"
 
 WRENCH_LOG_CATEGORY(resource_switching_agent, "Log category for ResourceSwitchingAgent");
@@ -11,76 +15,132 @@ using json = nlohmann::json;
 void ResourceSwitchingAgent::parse_failure_profile(const std::string& json_file)
 {
   std::ifstream file(json_file);
+  if (not file)
+    throw std::invalid_argument("Cannot open hardware failure profile: " + json_file);
   json j;
   file >> j;
 
   for (const auto& entry : j) {
     FailureEvent event;
-    event.type     = entry["type"];
-    event.resource = entry["resource"];
+    event.type     = entry.at("type");
+    event.resource = entry.at("resource");
     if (entry.contains("fraction"))
       event.fraction = entry["fraction"].get<double>();
-    event.turn_off_time = entry["turn_off_time"].get<double>();
+    event.turn_off_time = entry.at("turn_off_time").get<double>();
     if (entry.contains("turn_on_time"))
       event.turn_on_time = entry["turn_on_time"].get<double>();
 
-    failure_events_.push_back(event);
+    if (event.type != "cluster" && event.type != "link")
+      throw std::invalid_argument("Unknown hardware failure type: " + event.type);
+    if (event.type == "cluster" && not clusters_.count(event.resource))
+      throw std::invalid_argument("Unknown HPC system in hardware failure profile: " + event.resource);
+    if (event.fraction <= 0 || event.fraction > 1)
+      throw std::invalid_argument("Invalid fraction of HPC system '" + event.resource + "' to turn off");
+    if (event.turn_on_time >= 0 && event.turn_on_time <= event.turn_off_time)
+      throw std::invalid_argument("Resource '" + event.resource + "' turned back on before being turned off");
+
+    transitions_.push_back({event.turn_off_time, failure_events_.size(), false});
+    if (event.turn_on_time >= 0)
+      transitions_.push_back({event.turn_on_time, failure_events_.size(), true});
+    failure_events_.push_back(std::move(event));
   }
+  // Events that start and end at the same date are applied in the order of the profile
+  std::stable_sort(transitions_.begin(), transitions_.end(),
+                   [](const Transition& a, const Transition& b) { return a.date < b.date; });
 }
 
-void ResourceSwitchingAgent::schedule_events()
+void ResourceSwitchingAgent::set_job_scheduling_agent_network(
+    const std::vector<std::shared_ptr<JobSchedulingAgent>>& network)
+{
+  for (const auto& agent : network)
+    compute_nodes_[agent->get_hpc_system_name()].agent = agent;
+}
+
+void ResourceSwitchingAgent::resolve_compute_nodes()
 {
   for (const auto& event : failure_events_) {
-    this->setTimer(event.turn_off_time, "turn_off_" + event.resource + "_f" + std::to_string(event.fraction));
-    if (event.turn_on_time > 0)
-      this->setTimer(event.turn_on_time, "turn_on_" + event.resource + "_f" + std::to_string(event.fraction));
+    if (event.type == "link") {
+      if (not simgrid::s4u::Link::by_name_or_null(event.resource))
+        throw std::invalid_argument("Unknown link in hardware failure profile: " + event.resource);
+      continue;
+    }
+    auto& nodes = compute_nodes_[event.resource];
+    if (not nodes.hosts.empty())
+      continue;
+    const auto& hostnames = clusters_.at(event.resource);
+    for (auto it = hostnames.begin() + 1; it != hostnames.end(); ++it)
+      nodes.hosts.push_back(simgrid::s4u::Host::by_name(*it));
+    std::shuffle(nodes.hosts.begin(), nodes.hosts.end(), std::mt19937(std::hash<std::string>{}(event.resource)));
+    for (size_t position = 0; position < nodes.hosts.size(); position++)
+      nodes.positions.emplace(nodes.hosts[position], position);
+  }
+}
+
+void ResourceSwitchingAgent::switch_compute_nodes(FailureEvent& event, bool turn_on)
+{
+  auto& nodes = compute_nodes_.at(event.resource);
+  if (turn_on) {
+    // Move the nodes of the event back past the nodes that are off
+    for (auto host : event.hosts) {
+      auto position = nodes.positions.at(host);
+      auto last_off = nodes.hosts[--nodes.num_off];
+      std::swap(nodes.hosts[position], nodes.hosts[nodes.num_off]);
+      nodes.positions[last_off] = position;
+      nodes.positions[host]     = nodes.num_off;
+      host->turn_on();
+    }
+  } else {
+    // The next nodes that are on, as many as there are left if events overlap
+    auto num_to_turn_off = std::min(static_cast<size_t>(std::ceil(nodes.hosts.size() * event.fraction)),
+                                    nodes.hosts.size() - nodes.num_off);
+    event.hosts.assign(nodes.hosts.begin() + nodes.num_off, nodes.hosts.begin() + nodes.num_off + num_to_turn_off);
+    nodes.num_off += num_to_turn_off;
+    num_node_failures_ += num_to_turn_off;
+    for (auto host : event.hosts)
+      host->turn_off();
+  }
+  WRENCH_INFO("Turned %zu compute nodes of HPC system '%s' %s (%zu/%zu now off)", event.hosts.size(),
+              event.resource.c_str(), turn_on ? "ON" : "OFF", nodes.num_off, nodes.hosts.size());
+
+  if (nodes.agent && not event.hosts.empty()) {
+    std::vector<std::string> hostnames;
+    hostnames.reserve(event.hosts.size());
+    for (auto host : event.hosts)
+      hostnames.push_back(host->get_name());
+    nodes.agent->on_compute_nodes_switched(hostnames, turn_on);
+  }
+  if (turn_on)
+    event.hosts.clear();
+}
+
+void ResourceSwitchingAgent::apply(const Transition& transition)
+{
+  auto& event = failure_events_[transition.event];
+  if (event.type == "link") {
+    WRENCH_INFO("Turning Link '%s' %s", event.resource.c_str(), transition.turn_on ? "ON" : "OFF");
+    if (transition.turn_on)
+      simgrid::s4u::Link::by_name(event.resource)->turn_on();
+    else
+      simgrid::s4u::Link::by_name(event.resource)->turn_off();
+  } else {
+    switch_compute_nodes(event, transition.turn_on);
   }
 }
 
 int ResourceSwitchingAgent::main()
 {
-  WRENCH_INFO("Resource Switching Agent starting");
-  schedule_events();
-
-  while (true) {
-    auto event = this->waitForNextEvent();
-    if (auto timer_event = std::dynamic_pointer_cast<TimerEvent>(event)) {
-      const std::string& message = timer_event->message;
-      auto turn_on               = message.rfind("turn_on_", 0) == 0;
-      std::string prefix         = turn_on ? "turn_on_" : "turn_off_";
-
-      // Remove prefix
-      auto rest = message.substr(prefix.length());
-
-      // Split the rest of message on "_f"
-      auto pos           = rest.find("_f");
-      auto resource_name = rest.substr(0, pos);
-      auto fraction      = std::stod(rest.substr(pos + 2));
-
-      if (resource_name.find("link") != std::string::npos) {
-        if (turn_on) {
-          WRENCH_INFO("Turning Link '%s' ON", resource_name.c_str());
-          // wrench::S4U_Simulation::turnOnLink(resource_name);
-        } else {
-          WRENCH_INFO("Turning Link '%s' OFF", resource_name.c_str());
-          // wrench::S4U_Simulation::turnOffLink(resource_name);
-        }
-      } else {
-        auto hostnames      = clusters_[resource_name];
-        auto nhosts_to_stop = static_cast<size_t>(std::ceil(hostnames.size() * fraction));
-        if (turn_on) {
-          WRENCH_INFO("Turning %d%% of HPC system '%s' ON", static_cast<int>(100 * fraction), resource_name.c_str());
-        } else {
-          WRENCH_INFO("Turning %d%% of HPC system '%s' OFF", static_cast<int>(100 * fraction), resource_name.c_str());
-        }
-        // for (const auto& name : hostnames) {
-        //   if (turn_on)
-        //     wrench::S4U_Simulation::turnOnHost(name);
-        //   else
-        //     wrench::S4U_Simulation::turnOffHost(name);
-        // }
-      }
+  WRENCH_INFO("Resource Switching Agent starting (%zu hardware failure events)", failure_events_.size());
+  resolve_compute_nodes();
+
+  while (next_transition_ < transitions_.size()) {
+    if (transitions_[next_transition_].date > S4U_Simulation::getClock()) {
+      this->setTimer(transitions_[next_transition_].date, "next_transition");
+      this->waitForNextEvent();
     }
+    // All the transitions due at this date
+    while (next_transition_ < transitions_.size() &&
+           transitions_[next_transition_].date <= S4U_Simulation::getClock())
+      apply(transitions_[next_transition_++]);
   }
 
   return 0;
@@ -3,6 +3,7 @@
 #include "agents/JobSchedulingAgent.h"
 #include "info/HPCSystemStatus.h"
 #include "messages/ControlMessages.h"
+#include "utils/SystemStatusBoard.h"
 #include "utils/utils.h"
 
 WRENCH_LOG_CATEGORY(workload_centralized_submission_agent, "Log category for WorkloadCentralizedSubmissionAgent");
@@ -17,7 +18,8 @@ int WorkloadCentralizedSubmissionAgent::main()
   // Open and parse the JSON file that describes the entire workload
   auto jobs = extract_job_descriptions(job_list_);
   size_t total_num_jobs  = jobs->size();
-  int    next_job_to_submit = 0;
+  size_t next_job_to_submit   = 0;
+  size_t next_job_to_estimate = 0;
 
   // Two-phase state: arrival fires the Python decision; dispatch fires after decision_time
   // has elapsed in simulated time, matching the decentralized per-agent overhead.
@@ -38,14 +40,28 @@ int WorkloadCentralizedSubmissionAgent::main()
         // Query system statuses at arrival time and run the parallel Python decision.
         auto next_job = jobs->at(next_job_to_submit);
 
+        // Jobs arriving at the same date are estimated together upon the arrival of the first of them, estimates
+        // being reused until the system they were computed for changes. The following jobs of the burst are then
+        // estimated one by one on the systems they changed.
+        std::vector<std::shared_ptr<JobDescription>> burst;
+        if (next_job_to_estimate <= next_job_to_submit) {
+          burst.push_back(next_job);
+          for (size_t i = next_job_to_submit + 1;
+               i < total_num_jobs && jobs->at(i)->get_submission_time() == next_job->get_submission_time(); i++)
+            burst.push_back(jobs->at(i));
+          next_job_to_estimate = next_job_to_submit + burst.size();
+        }
+
         std::vector<HPCSystemInfo> systems_info;
         for (const auto& agent : job_scheduling_agents_) {
           const auto& system_description = agent->get_hpc_system_description();
-          const auto& batch_service      = agent->get_batch_compute_service();
-          auto current_status = std::make_shared<HPCSystemStatus>(
-              get_number_of_available_nodes_on(batch_service),
-              get_job_start_time_estimate_on(next_job, batch_service),
-              get_queue_length(batch_service));
+          auto status_snapshot           = agent->get_status_snapshot();
+          if (burst.size() > 1)
+            agent->estimate_job_start_times(burst);
+          auto current_status = std::make_shared<HPCSystemStatus>(status_snapshot->num_available_nodes,
+                                                                  agent->get_job_start_time_estimate(next_job),
+                                                                  status_snapshot->queue_length,
+                                                                  agent->get_num_off_nodes());
           systems_info.push_back({agent, system_description, current_status});
         }
 
@@ -2,6 +2,8 @@
 #include "agents/JobLifecycleTrackerAgent.h"
 #include "agents/JobSchedulingAgent.h"
 #include "messages/ControlMessages.h"
+#include "utils/BidPrefetcher.h"
+#include "utils/MessageOutbox.h"
 #include "utils/utils.h"
 
 WRENCH_LOG_CATEGORY(workload_submission_agent, "Log category for WorkloadSubmissionAgent");
@@ -16,8 +18,36 @@ int WorkloadSubmissionAgent::main()
   // Open and parse the JSON file that describes the entire workload
   auto jobs = extract_job_descriptions(job_list_);
   // Compute and store the total number of jobs in the workload in total_num_jobs
-  size_t total_num_jobs  = jobs->size();
-  int next_job_to_submit = 0;
+  size_t total_num_jobs       = jobs->size();
+  size_t next_job_to_submit   = 0;
+  size_t next_job_to_prefetch = 0;
+  size_t next_job_to_estimate = 0;
+
+  // Start computing the bids of the jobs that will arrive next, ahead of their arrival
+  auto prefetch_upcoming_bids = [&]() {
+    if (not bid_prefetcher_)
+      return;
+    for (; next_job_to_prefetch < std::min(total_num_jobs, next_job_to_submit + bid_prefetcher_->get_lookahead());
+         next_job_to_prefetch++)
+      for (const auto& agent : job_scheduling_agents_)
+        agent->prefetch_bid(jobs->at(next_job_to_prefetch));
+  };
+
+  prefetch_upcoming_bids();
+
+  // Estimate the start times of the jobs arriving at the same date together, on every HPC system
+  auto estimate_burst_start_times = [&]() {
+    if (next_job_to_estimate > next_job_to_submit)
+      return;
+    std::vector<std::shared_ptr<JobDescription>> burst = {jobs->at(next_job_to_submit)};
+    for (size_t i = next_job_to_submit + 1;
+         i < total_num_jobs && jobs->at(i)->get_submission_time() == burst.front()->get_submission_time(); i++)
+      burst.push_back(jobs->at(i));
+    next_job_to_estimate = next_job_to_submit + burst.size();
+    if (burst.size() > 1)
+      for (const auto& agent : job_scheduling_agents_)
+        agent->estimate_job_start_times(burst);
+  };
 
   // Set a timer for the arrival of the first job
   this->setTimer(jobs->at(0)->get_submission_time(), "Submit the next job");
@@ -30,6 +60,7 @@ int WorkloadSubmissionAgent::main()
 
     if (std::dynamic_pointer_cast<TimerEvent>(event)) {
       // It's a timer event, send the job description to the job scheduling agent of the HPC system in the description
+      estimate_burst_start_times();
       auto next_job            = jobs->at(next_job_to_submit);
       auto job_id              = next_job->get_job_id();
       auto job_submission_time = next_job->get_submission_time();
@@ -42,7 +73,15 @@ int WorkloadSubmissionAgent::main()
                                                         [job_HPCSystem](std::shared_ptr<wrench::JobSchedulingAgent> c) {
                                                           return c->get_hpc_system_name() == job_HPCSystem;
                                                         }));
-      target_job_scheduling_agent->commport->dputMessage(new JobRequestMessage(next_job, true));
+      if (outbox_) {
+        outbox_->send(target_job_scheduling_agent, new JobRequestMessage(next_job, true));
+        // The jobs submitted at the same date go together
+        if (next_job_to_submit + 1 == total_num_jobs ||
+            jobs->at(next_job_to_submit + 1)->get_submission_time() != job_submission_time)
+          outbox_->flush();
+      } else {
+        target_job_scheduling_agent->commport->dputMessage(new JobRequestMessage(next_job, true));
+      }
 
       // Notify the job lifecycle tracker
       tracker_->commport->dputMessage(
@@ -51,6 +90,7 @@ int WorkloadSubmissionAgent::main()
 
       // Set the timer for the next job
       next_job_to_submit++;
+      prefetch_upcoming_bids();
       if (next_job_to_submit < total_num_jobs) {
         auto next_job_arrival_time = jobs->at(next_job_to_submit)->get_submission_time();
         this->setTimer(next_job_arrival_time, "submit the next job");
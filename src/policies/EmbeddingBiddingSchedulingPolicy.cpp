@@ -0,0 +1,205 @@
+#include "policies/EmbeddingBiddingSchedulingPolicy.h"
+#include "utils/PythonCompat.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 4 x float32, i.e. one SSE (x86-64 baseline) or NEON register. GCC/Clang vector extensions keep this portable.
+typedef float float4 __attribute__((vector_size(16)));
+
+constexpr size_t NUM_LANES       = 4;
+constexpr size_t NUM_VECTORS     = EmbeddingBiddingSchedulingPolicy::EMBEDDING_SIZE / NUM_LANES;
+constexpr size_t NUM_FEATURES    = 5; // numerical features, followed by the one-hot encoding of the type
+constexpr float TYPE_WEIGHT      = 0.7f;
+constexpr double BASE_SPEED      = 1.5e12;
+constexpr double MAX_SPEED_RATIO = 7.5;
+
+inline float4 load(const EmbeddingBiddingSchedulingPolicy::Embedding& e, size_t i)
+{
+  float4 v;
+  std::memcpy(&v, e.values.data() + i * NUM_LANES, sizeof(v));
+  return v;
+}
+
+inline void store(EmbeddingBiddingSchedulingPolicy::Embedding& e, size_t i, float4 v)
+{
+  std::memcpy(e.values.data() + i * NUM_LANES, &v, sizeof(v));
+}
+
+float dot(const EmbeddingBiddingSchedulingPolicy::Embedding& a, const EmbeddingBiddingSchedulingPolicy::Embedding& b)
+{
+  float4 acc = load(a, 0) * load(b, 0);
+  for (size_t i = 1; i < NUM_VECTORS; i++)
+    acc += load(a, i) * load(b, i);
+  float sum = 0.0f;
+  for (size_t lane = 0; lane < NUM_LANES; lane++)
+    sum += acc[lane];
+  return sum;
+}
+
+void l2_normalize(EmbeddingBiddingSchedulingPolicy::Embedding& e)
+{
+  float norm = std::sqrt(dot(e, e));
+  if (not std::isfinite(norm) || norm < 1e-12f) {
+    e.values.fill(0.0f);
+    return;
+  }
+  for (size_t i = 0; i < NUM_VECTORS; i++)
+    store(e, i, load(e, i) / norm);
+}
+
+double log01(double x, double cap)
+{
+  x = std::min(std::max(0.0, x), cap);
+  return std::log1p(x) / std::log1p(cap);
+}
+
+EmbeddingBiddingSchedulingPolicy::Embedding make_embedding(const std::array<double, NUM_FEATURES>& features,
+                                                           size_t type_index)
+{
+  // Features are cast to float32 as by np.array(..., dtype=np.float32) before being weighted and normalized
+  EmbeddingBiddingSchedulingPolicy::Embedding e;
+  for (size_t i = 0; i < NUM_FEATURES; i++)
+    e.values[i] = static_cast<float>(features[i]);
+  e.values[NUM_FEATURES + type_index] = TYPE_WEIGHT;
+  l2_normalize(e);
+  return e;
+}
+
+double scaled_walltime(double walltime, double node_speed, bool has_gpu)
+{
+  double scaling_factor = node_speed / BASE_SPEED;
+  if (has_gpu)
+    scaling_factor = std::min(7.5, scaling_factor / 10.0);
+  scaling_factor = std::max(1e-9, scaling_factor);
+  return walltime / scaling_factor;
+}
+
+} // namespace
+
+EmbeddingBiddingSchedulingPolicy::Embedding EmbeddingBiddingSchedulingPolicy::embed_job(const JobDescription& job)
+{
+  constexpr double NODES_MAX   = 8600.0;
+  constexpr double WALL_MAX    = 60.0 * 60.0;
+  constexpr double MEM_MAX     = 512;
+  constexpr double STORAGE_MAX = 500.0 * 1000;
+
+  double nodes        = static_cast<double>(job.get_num_nodes());
+  double mem_per_node = job.get_requested_memory_gb() / std::max(1.0, nodes);
+  return make_embedding({log01(nodes, NODES_MAX), log01(static_cast<double>(job.get_walltime()), WALL_MAX),
+                         log01(mem_per_node, MEM_MAX), log01(job.get_requested_storage_gb(), STORAGE_MAX),
+                         job.needs_gpu() ? 1.0 : 0.0},
+                        static_cast<size_t>(job.get_job_type()));
+}
+
+EmbeddingBiddingSchedulingPolicy::Embedding
+EmbeddingBiddingSchedulingPolicy::embed_system(const HPCSystemDescription& system)
+{
+  constexpr double NODES_MAX        = 10624.0; // Aurora has the most nodes
+  constexpr double SPEED_MAX        = 312e12;  // Aurora speed in FLOPS
+  constexpr double MEM_PER_NODE_MAX = 12000.0;
+  constexpr double STORAGE_MAX      = 700e6; // 700 PB for Summit
+
+  return make_embedding({log01(static_cast<double>(system.get_num_nodes()), NODES_MAX),
+                         log01(system.get_node_speed(), SPEED_MAX),
+                         log01(static_cast<double>(system.get_memory_amount_in_gb()), MEM_PER_NODE_MAX),
+                         log01(static_cast<double>(system.get_storage_amount_in_gb()), STORAGE_MAX),
+                         system.has_gpu() ? 1.0 : 0.0},
+                        static_cast<size_t>(system.get_type()));
+}
+
+double EmbeddingBiddingSchedulingPolicy::embedding_bid(const JobDescription& job, const HPCSystemDescription& system,
+                                                       const Embedding& system_embedding, const HPCSystemStatus& status,
+                                                       double current_simulated_time)
+{
+  // Every quantity is converted to double as the Python script does, and expressions keep the same evaluation order.
+  const double nodes_req       = static_cast<double>(job.get_num_nodes());
+  const double req_walltime    = static_cast<double>(job.get_walltime());
+  const double submission_time = job.get_submission_time();
+  const double sys_nodes       = static_cast<double>(system.get_num_nodes());
+  const bool sys_has_gpu       = system.has_gpu();
+  const double sys_speed       = system.get_node_speed();
+  const double sys_total_mem   = static_cast<double>(system.get_memory_amount_in_gb()) * sys_nodes;
+
+  // Feasibility
+  if (nodes_req > sys_nodes)
+    return 0.0;
+  if (job.needs_gpu() && not sys_has_gpu)
+    return 0.0;
+  if (job.get_requested_memory_gb() > sys_total_mem)
+    return 0.0;
+  if (job.get_requested_storage_gb() > system.get_storage_amount_in_gb())
+    return 0.0;
+  if (req_walltime <= 0)
+    return 0.0;
+
+  // Relative node availability
+  const double sys_avail_nodes = static_cast<double>(status.get_current_num_avaibable_nodes());
+  double avail_frac             = sys_avail_nodes / std::max(1.0, sys_nodes);
+  double relative_headroom      = sys_avail_nodes / std::max(1.0, nodes_req);
+  double relative_headroom_feat = std::log1p(relative_headroom) / std::log1p(std::max(2.0, sys_nodes));
+  double headroom_feat          = 0.75 * avail_frac + 0.25 * relative_headroom_feat;
+  headroom_feat                 = std::max(0.0, std::min(1.0, headroom_feat));
+
+  // Queue penalty
+  double queued_jobs         = static_cast<double>(status.get_queue_length());
+  double running_nodes       = std::max(0.0, std::min(sys_nodes, sys_nodes - sys_avail_nodes));
+  double queue_jobs_per_node = queued_jobs / std::max(1.0, sys_nodes);
+  double running_node_load   = running_nodes / std::max(1.0, sys_nodes);
+  double queue_pressure      = queue_jobs_per_node + 0.25 * running_node_load;
+  double queue_feat          = std::exp(-4.0 * queue_pressure);
+
+  // Estimated slowdown using system status
+  double now            = std::max(current_simulated_time, submission_time);
+  double wait_time      = std::max(0.0, status.get_current_job_start_time_estimate() - now);
+  double pred_exec_time = scaled_walltime(req_walltime, sys_speed, sys_has_gpu);
+  double slowdown       = (wait_time + pred_exec_time) / std::max(1.0, pred_exec_time);
+  double alpha          = 0.5;
+  double slowdown_feat  = std::exp(-alpha * slowdown);
+
+  // Apply AI cross-site data transfer penalty to the time component
+  const auto& job_site = job.get_hpc_site();
+  const auto& sys_site = system.get_site();
+  if (job.get_job_type() == JobType::AI && not job_site.empty() && not sys_site.empty() && job_site != sys_site) {
+    PythonRandom rng(md5_seed(std::to_string(job.get_job_id()) + "_" + system.get_name() + "_ai_xfer"));
+    double ai_data_xfer_penalty = rng.uniform(0.10, 0.20);
+    slowdown_feat               = std::max(0.0, slowdown_feat - ai_data_xfer_penalty);
+  }
+
+  double speed_ratio = sys_speed / BASE_SPEED;
+  if (sys_has_gpu)
+    speed_ratio = std::min(MAX_SPEED_RATIO, speed_ratio / 10.0);
+  double speed_feat = std::max(0.0, std::min(1.0, speed_ratio / MAX_SPEED_RATIO));
+
+  double completion_time = wait_time + pred_exec_time;
+  double completion_feat = std::exp(-completion_time / std::max(1.0, req_walltime));
+
+  double dynamic_bid = 0.15 * headroom_feat + 0.20 * slowdown_feat + 0.20 * queue_feat + 0.25 * speed_feat +
+                       0.20 * completion_feat;
+
+  double static_bid = std::max(0.0, static_cast<double>(dot(embed_job(job), system_embedding)));
+  double bid        = 0.2 * static_bid + 0.8 * dynamic_bid;
+  if (not std::isfinite(bid))
+    bid = 0.0;
+
+  return python_round(bid, 6);
+}
+
+std::pair<double, double>
+EmbeddingBiddingSchedulingPolicy::compute_bid(const std::shared_ptr<JobDescription>& job_description,
+                                              const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
+                                              const std::shared_ptr<HPCSystemStatus>& hpc_system_status)
+{
+  // As the Python script, report the time actually spent computing the bid
+  auto start = std::chrono::steady_clock::now();
+  // The embedding of the local system is precomputed, only embed another system on the fly
+  auto system_embedding =
+      (hpc_system_description == local_system_) ? local_embedding_ : embed_system(*hpc_system_description);
+  auto bid = embedding_bid(*job_description, *hpc_system_description, system_embedding, *hpc_system_status,
+                           wrench::S4U_Simulation::getClock());
+  auto bid_generation_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return std::make_pair(bid, bid_generation_time);
+}
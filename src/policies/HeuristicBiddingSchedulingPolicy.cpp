@@ -0,0 +1,207 @@
+#include "policies/HeuristicBiddingSchedulingPolicy.h"
+#include "utils/PythonCompat.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+struct CompatibilityRange {
+  bool defined;
+  double min_score;
+  double max_score;
+};
+
+constexpr size_t compatibility_index(JobType job_type, bool needs_gpu, HPCSystemType system_type, bool has_gpu)
+{
+  return ((static_cast<size_t>(job_type) * 2 + needs_gpu) * 4 + static_cast<size_t>(system_type)) * 2 + has_gpu;
+}
+
+// RESOURCE_COMPATIBILITY_TABLE of HeuristicBidding.py, indexed by enum values instead of (label, gpu) tuples
+constexpr std::array<CompatibilityRange, 64> make_resource_compatibility_table()
+{
+  std::array<CompatibilityRange, 64> table{};
+  auto set = [&table](JobType job, bool job_gpu, HPCSystemType sys, bool sys_gpu, double min_score, double max_score) {
+    table[compatibility_index(job, job_gpu, sys, sys_gpu)] = {true, min_score, max_score};
+  };
+  using J = JobType;
+  using S = HPCSystemType;
+
+  // ================= HPC JOB =================
+  set(J::HPC, true, S::HPC, true, 1.00, 1.00);
+  set(J::HPC, true, S::AI, true, 0.90, 0.95);
+  set(J::HPC, true, S::HYBRID, true, 0.90, 0.95);
+  set(J::HPC, true, S::HYBRID, false, 0.00, 0.00);
+  set(J::HPC, true, S::STORAGE, false, 0.00, 0.00);
+
+  set(J::HPC, false, S::HPC, true, 0.80, 0.90);
+  set(J::HPC, false, S::AI, true, 0.80, 0.90);
+  set(J::HPC, false, S::HYBRID, true, 0.80, 0.90);
+  set(J::HPC, false, S::HYBRID, false, 0.90, 0.95);
+  set(J::HPC, false, S::STORAGE, false, 0.70, 0.80);
+
+  // ================= AI JOB =================
+  set(J::AI, true, S::HPC, true, 0.90, 0.95);
+  set(J::AI, true, S::AI, true, 1.00, 1.00);
+  set(J::AI, true, S::HYBRID, true, 0.90, 0.95);
+  set(J::AI, true, S::HYBRID, false, 0.00, 0.00);
+  set(J::AI, true, S::STORAGE, false, 0.00, 0.00);
+
+  set(J::AI, false, S::HPC, true, 0.80, 0.90);
+  set(J::AI, false, S::AI, true, 0.80, 0.90);
+  set(J::AI, false, S::HYBRID, true, 0.80, 0.90);
+  set(J::AI, false, S::HYBRID, false, 0.90, 0.95);
+  set(J::AI, false, S::STORAGE, false, 0.70, 0.80);
+
+  // ================= HYB JOB =================
+  set(J::HYBRID, true, S::HPC, true, 0.90, 0.95);
+  set(J::HYBRID, true, S::AI, true, 0.90, 0.95);
+  set(J::HYBRID, true, S::HYBRID, true, 1.00, 1.00);
+  set(J::HYBRID, true, S::HYBRID, false, 0.00, 0.00);
+  set(J::HYBRID, true, S::STORAGE, false, 0.00, 0.00);
+
+  set(J::HYBRID, false, S::HPC, true, 0.80, 0.90);
+  set(J::HYBRID, false, S::AI, true, 0.80, 0.90);
+  set(J::HYBRID, false, S::HYBRID, true, 0.80, 0.90);
+  set(J::HYBRID, false, S::HYBRID, false, 1.00, 1.00);
+  set(J::HYBRID, false, S::STORAGE, false, 0.75, 0.85);
+
+  // ================= STO JOB =================
+  set(J::STORAGE, false, S::HPC, true, 0.70, 0.80);
+  set(J::STORAGE, false, S::AI, true, 0.70, 0.80);
+  set(J::STORAGE, false, S::HYBRID, true, 0.70, 0.80);
+  set(J::STORAGE, false, S::HYBRID, false, 0.90, 0.95);
+  set(J::STORAGE, false, S::STORAGE, false, 1.00, 1.00);
+  return table;
+}
+
+constexpr auto RESOURCE_COMPATIBILITY_TABLE = make_resource_compatibility_table();
+
+// Normalized type labels used in the seed strings of the Python script (HYBRID -> HYB, STORAGE -> STO)
+constexpr const char* TYPE_LABELS[4] = {"HPC", "AI", "HYB", "STO"};
+
+} // namespace
+
+double HeuristicBiddingSchedulingPolicy::heuristic_bid(const JobDescription& job_description,
+                                                       const HPCSystemDescription& hpc_system_description,
+                                                       const HPCSystemStatus& hpc_system_status)
+{
+  // Every quantity is converted to double as the Python script does, and expressions keep the same evaluation order.
+  const double nodes_req       = static_cast<double>(job_description.get_num_nodes());
+  const bool req_gpu           = job_description.needs_gpu();
+  const double req_walltime    = static_cast<double>(job_description.get_walltime());
+  const double submission_time = job_description.get_submission_time();
+  const auto job_type          = job_description.get_job_type();
+
+  const double sys_nodes       = static_cast<double>(hpc_system_description.get_num_nodes());
+  const bool sys_has_gpu       = hpc_system_description.has_gpu();
+  const auto sys_type          = hpc_system_description.get_type();
+  const double sys_speed       = hpc_system_description.get_node_speed();
+  const double sys_avail_nodes = static_cast<double>(hpc_system_status.get_current_num_avaibable_nodes());
+
+  // --- 1. Feasibility ---
+  if (nodes_req > sys_nodes)
+    return 0.0;
+  if (req_gpu && not sys_has_gpu)
+    return 0.0;
+  if (job_description.get_requested_memory_gb() >
+      static_cast<double>(hpc_system_description.get_memory_amount_in_gb()) * hpc_system_description.get_num_nodes())
+    return 0.0;
+  if (job_description.get_requested_storage_gb() > hpc_system_description.get_storage_amount_in_gb())
+    return 0.0;
+
+  // --- 2. Utilization Score (Preference for availability) ---
+  double used_nodes = sys_nodes - sys_avail_nodes;
+  double node_util  = used_nodes / std::max(1.0, sys_nodes);
+  double score_util = 1.0 - node_util;
+
+  // --- 3. Node Fit Bonus (Preference for jobs that fit well within available resources) ---
+  double total_nodes    = std::max(1.0, sys_nodes);
+  double required_nodes = std::max(0.0, nodes_req);
+  double job_fraction   = required_nodes / total_nodes;
+
+  double node_fit_bonus = 0.0;
+  if (job_fraction < 0.2)
+    node_fit_bonus += 0.12;
+  else if (job_fraction < 0.3)
+    node_fit_bonus += 0.08;
+  else
+    node_fit_bonus += 0.04;
+  if (sys_avail_nodes >= required_nodes * 2.0)
+    node_fit_bonus += 0.10;
+
+  // --- 4. Resource Compatibility (Type Matching) ---
+  double score_resource = 0.5; // Neutral compatibility for unexpected combinations
+  const auto& range     = RESOURCE_COMPATIBILITY_TABLE[compatibility_index(job_type, req_gpu, sys_type, sys_has_gpu)];
+  if (range.defined) {
+    auto seed_string = std::to_string(job_description.get_job_id()) + "_" +
+                       TYPE_LABELS[static_cast<size_t>(sys_type)] + "_" + TYPE_LABELS[static_cast<size_t>(job_type)] +
+                       "_" + python_bool(req_gpu) + "_" + python_bool(sys_has_gpu);
+    PythonRandom rng(md5_seed(seed_string));
+    score_resource = rng.uniform(range.min_score, range.max_score);
+  }
+
+  // --- 5. Time Cost Calculation ---
+  constexpr double BASE_SPEED      = 1.5e12;
+  constexpr double MAX_SPEED_RATIO = 7.5;
+
+  // A. Queue Wait Time
+  double wait_time = std::max(0.0, hpc_system_status.get_current_job_start_time_estimate() - submission_time);
+
+  // B. Execution Time (adjusted for hardware speed), see scaled_walltime()
+  double scaling_factor = sys_speed / BASE_SPEED;
+  if (sys_has_gpu)
+    scaling_factor = std::min(7.5, scaling_factor / 10.0);
+  scaling_factor        = std::max(1e-9, scaling_factor);
+  double pred_exec_time = req_walltime / scaling_factor;
+
+  double total_time_cost = wait_time + pred_exec_time;
+  double slowdown        = std::max(0.0, total_time_cost) / std::max(pred_exec_time, 1.0);
+  double alpha           = 0.5;
+  double norm_slowdown   = std::exp(-alpha * slowdown);
+
+  // C. Speed penalty based on system speed relative to a baseline
+  double speed_ratio = sys_speed / BASE_SPEED;
+  if (sys_has_gpu)
+    speed_ratio = std::min(MAX_SPEED_RATIO, speed_ratio / 10.0);
+  double speed_penalty       = MAX_SPEED_RATIO - speed_ratio;
+  double speed_penalty_score = 1.0 - (speed_penalty / MAX_SPEED_RATIO);
+
+  double time_score = 0.5 * norm_slowdown + 0.5 * speed_penalty_score;
+
+  // --- 6. Weighted Aggregation ---
+  double w_util     = 0.3;
+  double w_resource = 0.1;
+  double w_speed    = 0.4;
+  double w_node_fit = 0.2;
+
+  // --- 7. AI data-transfer penalty on final score (10-20%) ---
+  double ai_data_xfer_penalty = 0.0;
+  const auto& job_site        = job_description.get_hpc_site();
+  const auto& sys_site        = hpc_system_description.get_site();
+  if (job_type == JobType::AI && not job_site.empty() && not sys_site.empty() && job_site != sys_site) {
+    PythonRandom rng(
+        md5_seed(std::to_string(job_description.get_job_id()) + "_" + hpc_system_description.get_name() + "_ai_xfer"));
+    ai_data_xfer_penalty = rng.uniform(0.10, 0.20);
+  }
+
+  double final_score = ((score_util * w_util) + (score_resource * w_resource) +
+                        ((time_score - ai_data_xfer_penalty) * w_speed) + (node_fit_bonus * w_node_fit)) /
+                       (w_util + w_resource + w_speed + w_node_fit);
+
+  return python_round(final_score, 4);
+}
+
+std::pair<double, double>
+HeuristicBiddingSchedulingPolicy::compute_bid(const std::shared_ptr<JobDescription>& job_description,
+                                              const std::shared_ptr<HPCSystemDescription>& hpc_system_description,
+                                              const std::shared_ptr<HPCSystemStatus>& hpc_system_status)
+{
+  // As the Python script, report the time actually spent computing the bid
+  auto start = std::chrono::steady_clock::now();
+  auto bid   = heuristic_bid(*job_description, *hpc_system_description, *hpc_system_status);
+  auto bid_generation_time =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return std::make_pair(bid, bid_generation_time);
+}
@@ -1,36 +1,227 @@
+#include "policies/EmbeddingBiddingSchedulingPolicy.h"
+#include "policies/HeuristicBiddingSchedulingPolicy.h"
 #include "policies/PureLocalSchedulingPolicy.h"
 #include "policies/PythonBiddingSchedulingPolicy.h"
 #include "policies/RandomBiddingSchedulingPolicy.h"
+#include "utils/utils.h"
 
+#include <algorithm>
 #include <stdexcept>
 
-std::shared_ptr<SchedulingPolicy> SchedulingPolicy::create_scheduling_policy(const std::string& policy_name,
-                                                                             const std::string& python_script_name,
-                                                                             const std::string& bidder_prompt_file)
+std::shared_ptr<SchedulingPolicy>
+SchedulingPolicy::create_scheduling_policy(const std::string& policy_name, const std::string& python_script_name,
+                                           const std::string& bidder_prompt_file,
+                                           const std::shared_ptr<BidderBackend>& bidder_backend,
+                                           const std::shared_ptr<BidJournal>& bid_journal)
 {
   if (policy_name == "PureLocal")
     return std::make_shared<PureLocalSchedulingPolicy>();
   else if (policy_name == "RandomBidding")
     return std::make_shared<RandomBiddingSchedulingPolicy>();
+  else if (policy_name == "HeuristicBidding")
+    return std::make_shared<HeuristicBiddingSchedulingPolicy>();
+  else if (policy_name == "EmbeddingBidding")
+    return std::make_shared<EmbeddingBiddingSchedulingPolicy>();
   else if (policy_name == "PythonBidding") {
     if (not python_script_name.empty())
-      return std::make_shared<PythonBiddingSchedulingPolicy>(python_script_name, bidder_prompt_file);
+      return std::make_shared<PythonBiddingSchedulingPolicy>(python_script_name, bidder_prompt_file, bidder_backend,
+                                                             bid_journal);
     else
       throw std::runtime_error("Python script needed");
   } else
     throw std::invalid_argument("Unknown scheduling policy: " + policy_name);
 }
 
-void SchedulingPolicy::init_num_received_bids(int job_id)
+void SchedulingPolicy::mark_agent_as_failed(std::shared_ptr<wrench::JobSchedulingAgent> agent)
 {
-  for (const auto& agent : healthy_job_scheduling_agent_network_)
-    num_received_bids_[job_id].try_emplace(agent->getName(), 0);
+  auto it =
+      std::find(healthy_job_scheduling_agent_network_.begin(), healthy_job_scheduling_agent_network_.end(), agent);
+  if (it == healthy_job_scheduling_agent_network_.end())
+    return;
+  healthy_job_scheduling_agent_network_.erase(it);
+  failed_job_scheduling_agent_network_.push_back(agent);
+  aggregation_tree_.clear();
 }
 
-void SchedulingPolicy::mark_agent_as_failed(std::shared_ptr<wrench::JobSchedulingAgent> agent)
+void SchedulingPolicy::mark_agent_as_recovered(const std::shared_ptr<wrench::JobSchedulingAgent>& agent)
 {
-  healthy_job_scheduling_agent_network_.erase(
-      std::remove(healthy_job_scheduling_agent_network_.begin(), healthy_job_scheduling_agent_network_.end(), agent),
-      healthy_job_scheduling_agent_network_.end());
-  failed_job_scheduling_agent_network_.push_back(agent);
+  auto it = std::find(failed_job_scheduling_agent_network_.begin(), failed_job_scheduling_agent_network_.end(), agent);
+  if (it == failed_job_scheduling_agent_network_.end())
+    return;
+  failed_job_scheduling_agent_network_.erase(it);
+  // Aggregation trees follow the order of the network
+  healthy_job_scheduling_agent_network_.clear();
+  for (const auto& other_agent : job_scheduling_agent_network_)
+    if (std::find(failed_job_scheduling_agent_network_.begin(), failed_job_scheduling_agent_network_.end(),
+                  other_agent) == failed_job_scheduling_agent_network_.end())
+      healthy_job_scheduling_agent_network_.push_back(other_agent);
+  aggregation_tree_.clear();
+}
+
+void SchedulingPolicy::broadcast_job_description(const wrench::JobSchedulingAgent* agent,
+                                                 const std::shared_ptr<JobDescription>& job_description)
+{
+  for (const auto& other_agent : get_job_scheduling_agent_network())
+    if (other_agent.get() != agent && not is_excluded_from_auction(job_description, other_agent))
+      send_message(other_agent, new wrench::JobRequestMessage(job_description, agent));
+}
+
+std::shared_ptr<wrench::JobSchedulingAgent> SchedulingPolicy::determine_bid_winner(
+    const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids) const
+{
+  if (all_bids.empty())
+    return nullptr;
+
+  auto max_it = std::max_element(all_bids.begin(), all_bids.end(), [](const auto& a, const auto& b) {
+    if (a.second != b.second)
+      return a.second < b.second; // (bid, tie_breaker): higher value wins
+    else
+      return a.first < b.first;
+  });
+
+  return max_it->first;
+}
+
+bool SchedulingPolicy::is_prefiltered_out(const std::shared_ptr<JobDescription>& job_description,
+                                          const std::shared_ptr<HPCSystemDescription>& hpc_system_description) const
+{
+  return feasibility_prefilter_ && bids_zero_on_infeasible_jobs() &&
+         do_not_pass_acceptance_tests(job_description, hpc_system_description);
+}
+
+bool SchedulingPolicy::is_excluded_from_auction(const std::shared_ptr<JobDescription>& job_description,
+                                                const std::shared_ptr<wrench::JobSchedulingAgent>& agent) const
+{
+  return exclude_infeasible_bidders_ && bid_aggregation_ == BidAggregation::ALL_TO_ALL &&
+         agent->get_hpc_system_name() != job_description->get_hpc_system() &&
+         is_prefiltered_out(job_description, agent->get_hpc_system_description());
+}
+
+size_t SchedulingPolicy::get_num_feasible_bidders(const std::shared_ptr<JobDescription>& job_description)
+{
+  return std::count_if(healthy_job_scheduling_agent_network_.begin(), healthy_job_scheduling_agent_network_.end(),
+                       [this, &job_description](const auto& agent) {
+                         return not is_prefiltered_out(job_description, agent->get_hpc_system_description());
+                       });
+}
+
+std::optional<size_t> SchedulingPolicy::get_aggregation_position(const wrench::JobSchedulingAgent* agent)
+{
+  const auto& network = healthy_job_scheduling_agent_network_;
+  if (aggregation_tree_.empty() && not network.empty()) {
+    aggregation_positions_.clear();
+    std::unordered_map<std::string, size_t> site_brokers;
+    for (size_t position = 0; position < network.size(); position++) {
+      aggregation_positions_.emplace(network[position].get(), position);
+      size_t parent = 0;
+      if (bid_aggregation_ == BidAggregation::TREE) {
+        parent = position == 0 ? 0 : (position - 1) / bid_aggregation_arity_;
+      } else {
+        // Agents report to the broker of their site, and brokers to that of the first site
+        auto broker = site_brokers.try_emplace(network[position]->get_hpc_system_description()->get_site(), position);
+        parent      = broker.second ? 0 : broker.first->second;
+      }
+      aggregation_tree_.push_back({parent, 0, 0});
+      if (parent != position)
+        aggregation_tree_[parent].num_children++;
+    }
+    // Parents come before their children in the network
+    for (size_t position = network.size() - 1; position > 0; position--) {
+      auto& parent  = aggregation_tree_[aggregation_tree_[position].parent];
+      parent.height = std::max(parent.height, aggregation_tree_[position].height + 1);
+    }
+  }
+  auto it = aggregation_positions_.find(agent);
+  if (it == aggregation_positions_.end())
+    return std::nullopt;
+  return it->second;
+}
+
+size_t SchedulingPolicy::get_num_needed_bids(const wrench::JobSchedulingAgent* agent)
+{
+  if (is_local_only())
+    return 1;
+  if (not is_aggregating_bids())
+    return healthy_job_scheduling_agent_network_.size();
+  auto position = get_aggregation_position(agent);
+  return position ? 1 + aggregation_tree_[*position].num_children : 1;
+}
+
+size_t SchedulingPolicy::get_aggregation_height(const wrench::JobSchedulingAgent* agent)
+{
+  if (not is_aggregating_bids())
+    return 0;
+  auto position = get_aggregation_position(agent);
+  return position ? aggregation_tree_[*position].height : 0;
+}
+
+void SchedulingPolicy::send_bid_message(const wrench::JobSchedulingAgent* sender,
+                                        const std::shared_ptr<wrench::JobSchedulingAgent>& receiver,
+                                        wrench::ExecutionControllerCustomEventMessage* message)
+{
+  if (receiver.get() != sender) {
+    num_bid_messages_++;
+    if (receiver->get_hpc_system_description()->get_site() != sender->get_hpc_system_description()->get_site())
+      num_wide_area_bid_messages_++;
+  }
+  send_message(receiver, message);
+}
+
+void SchedulingPolicy::send_message(const std::shared_ptr<wrench::JobSchedulingAgent>& receiver,
+                                    wrench::ExecutionControllerCustomEventMessage* message)
+{
+  outbox_.send(receiver, message);
+}
+
+void SchedulingPolicy::broadcast_bid_to_network(const std::shared_ptr<wrench::S4U_Daemon>& bidder,
+                                                const std::shared_ptr<JobDescription>& job_description, double bid,
+                                                double tie_breaker)
+{
+  auto agent = std::static_pointer_cast<wrench::JobSchedulingAgent>(bidder);
+  if (bid_aggregation_ == BidAggregation::ALL_TO_ALL) {
+    // Excluded agents are not sent the bids, but count among the needed ones: their null bids are recorded locally (see
+    // JobSchedulingAgent::record_excluded_bids).
+    for (const auto& other_agent : healthy_job_scheduling_agent_network_)
+      if (not is_excluded_from_auction(job_description, other_agent))
+        send_bid_message(agent.get(), other_agent,
+                         new wrench::BidOnJobMessage(bidder, job_description, bid, tie_breaker));
+    return;
+  }
+
+  // The local bid and the best bid of each subtree rooted at a child of this agent are needed. Leaves directly send
+  // their bid to their parent.
+  auto position = get_aggregation_position(agent.get());
+  if (not position) {
+    send_bid_message(agent.get(), agent, new wrench::BidOnJobMessage(bidder, job_description, bid, tie_breaker));
+    return;
+  }
+  const auto& node = aggregation_tree_[*position];
+  auto receiver = node.num_children == 0 ? healthy_job_scheduling_agent_network_[node.parent] : agent;
+  send_bid_message(agent.get(), receiver, new wrench::BidOnJobMessage(bidder, job_description, bid, tie_breaker));
+}
+
+bool SchedulingPolicy::forward_best_bid(
+    const wrench::JobSchedulingAgent* agent, const std::shared_ptr<JobDescription>& job_description,
+    const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids)
+{
+  if (not is_aggregating_bids())
+    return false;
+  auto position = get_aggregation_position(agent);
+  if (not position || aggregation_tree_[*position].parent == *position)
+    return false;
+
+  // Best bid of the subtree rooted at this agent, as determined by the policy
+  auto best_bidder               = determine_bid_winner(all_bids);
+  const auto& [bid, tie_breaker] = all_bids.at(best_bidder);
+  send_bid_message(agent, healthy_job_scheduling_agent_network_[aggregation_tree_[*position].parent],
+                   new wrench::BidOnJobMessage(best_bidder, job_description, bid, tie_breaker, agent));
+  return true;
+}
+
+void SchedulingPolicy::announce_bid_winner(const wrench::JobSchedulingAgent* agent,
+                                           const std::shared_ptr<wrench::JobSchedulingAgent>& winner,
+                                           const std::shared_ptr<JobDescription>& job_description,
+                                           const std::string& bids)
+{
+  send_bid_message(agent, winner, new wrench::BidWinnerMessage(job_description, bids));
 }
@@ -7,11 +7,22 @@
 #include "agents/HeartbeatMonitorAgent.h"
 #include "agents/JobLifecycleTrackerAgent.h"
 #include "agents/JobSchedulingAgent.h"
+#include "agents/ResourceSwitchingAgent.h"
 #include "agents/WorkloadCentralizedSubmissionAgent.h"
 #include "agents/WorkloadSubmissionAgent.h"
 #include "info/HPCSystemDescription.h"
 #include "policies/CentralizedSchedulingPolicy.h"
 #include "policies/SchedulingPolicy.h"
+#include "utils/AvailabilityProfile.h"
+#include "utils/BidCache.h"
+#include "utils/BidDispatcher.h"
+#include "utils/BidJournal.h"
+#include "utils/BidPrefetcher.h"
+#include "utils/BidderBackend.h"
+#include "utils/MessageOutbox.h"
+#include "utils/MessagePool.h"
+#include "utils/StartTimeEstimateCache.h"
+#include "utils/SystemStatusBoard.h"
 
 WRENCH_LOG_CATEGORY(swarm_dmas, "Log category for SWARM Distributed Multi-Agent Scheduling simulator");
 
@@ -66,9 +77,96 @@ int main(int argc, char** argv)
     }
     bidder_prompt_file = prompt_path.string();
   }
+  // How external bidders are run: "fork" (one python3 process per bid) or "pool" (long-lived worker processes). Unless
+  // shared, each job scheduling agent gets its own pool of bidder_pool_size workers.
+  std::string bidder_backend           = j.value("bidder_backend", "fork");
+  size_t bidder_pool_size              = j.value("bidder_pool_size", 1);
+  bool bidder_pool_shared              = j.value("bidder_pool_shared", false);
+  // Number of host threads running external bidders concurrently (0: each agent waits for its bidder in turn)
+  size_t bid_dispatch_threads          = j.value("bid_dispatch_threads", 0);
+  // Number of upcoming jobs whose bids are computed ahead of their arrival, for bidders declaring BID_INPUTS (0: none)
+  size_t bid_prefetch_lookahead        = j.value("bid_prefetch_lookahead", 0);
+  // Record the bids of external bidders in a journal, or replay them from it without running any bidder
+  std::string bid_journal_file         = j.value("bid_journal", "");
+  std::string bid_journal_mode         = j.value("bid_journal_mode", "replay");
+  // Reuse bids across jobs and system statuses that only differ by less than the given quantization steps
+  nlohmann::json bid_cache_config      = j.value("bid_cache", nlohmann::json());
+  // Whether centralized_policy implements the batched protocol of CentralizedScheduling.py (one call per job, bids on
+  // all systems) rather than the per-system protocol of the decentralized bidders (one call per job and system)
+  bool centralized_batched_bids        = j.value("centralized_batched_bids", false);
+  // Compare the incrementally maintained idle nodes of each system to those of its batch compute service
+  bool check_idle_nodes                = j.value("check_idle_nodes", false);
+  // Reuse the start time estimates of each batch compute service until its queue or its running jobs change
+  bool cache_start_time_estimates      = j.value("cache_start_time_estimates", true);
+  // How start times are estimated: by the batch compute service ("batch") or from an availability profile ("profile"),
+  // possibly validated against the batch compute service
+  std::string start_time_estimator     = j.value("start_time_estimator", "batch");
+  bool validate_start_time_estimator   = j.value("validate_start_time_estimator", false);
+  if (start_time_estimator != "batch" && start_time_estimator != "profile") {
+    std::cerr << "Invalid start_time_estimator (expected \"batch\" or \"profile\"): " << start_time_estimator
+              << std::endl;
+    exit(1);
+  }
+  // Share the status of the HPC systems, as published by their agents upon local changes, rather than querying the
+  // batch compute services for every job (or for every read in strict mode)
+  bool status_board_enabled            = j.value("status_board", false);
+  bool status_board_strict             = j.value("status_board_strict", false);
+  // How the job scheduling agents exchange their bids: "all_to_all" (every agent determines the winner), "tree" (the
+  // best bids go up a tree of bid_aggregation_arity children per agent, whose root announces the winner), or "site"
+  // (the best bid of each site, as determined by its broker, goes to a top-level auction across sites)
+  std::string bid_aggregation          = j.value("bid_aggregation", "all_to_all");
+  size_t bid_aggregation_arity         = j.value("bid_aggregation_arity", 2);
+  if ((bid_aggregation != "all_to_all" && bid_aggregation != "tree" && bid_aggregation != "site") ||
+      bid_aggregation_arity < 1) {
+    std::cerr << "Invalid bid_aggregation (expected \"all_to_all\", \"tree\", or \"site\") or bid_aggregation_arity "
+              << "(expected at least 1): " << bid_aggregation << ", " << bid_aggregation_arity << std::endl;
+    exit(1);
+  }
+  // Close the auctions still in flight after this delay with the bids received so far, if a quorum of them
+  double auction_deadline = j.value("auction_deadline", 0.0);
+  double auction_quorum   = j.value("auction_quorum", 0.5);
+  if (auction_deadline < 0 || auction_quorum < 0 || auction_quorum > 1) {
+    std::cerr << "Invalid auction_deadline (expected at least 0) or auction_quorum (expected between 0 and 1): "
+              << auction_deadline << ", " << auction_quorum << std::endl;
+    exit(1);
+  }
+  // Bid 0 natively on the jobs that do not pass the acceptance tests of a system, and, in decentralized mode with
+  // all_to_all bid aggregation, possibly do not even send them to its agent
+  bool feasibility_prefilter      = j.value("feasibility_prefilter", true);
+  bool exclude_infeasible_bidders = j.value("exclude_infeasible_bidders", false);
+  if (exclude_infeasible_bidders && (not feasibility_prefilter || bid_aggregation != "all_to_all")) {
+    std::cerr << "Invalid exclude_infeasible_bidders (requires feasibility_prefilter and \"all_to_all\" "
+              << "bid_aggregation): " << bid_aggregation << std::endl;
+    exit(1);
+  }
+  // Send the job requests and bids bound for the same agent at the same date as a single message
+  bool coalesce_messages               = j.value("coalesce_messages", false);
   double heartbeat_period              = j["heartbeat_period"].get<double>();
   double heartbeat_expiration          = j["heartbeat_expiration"].get<double>();
   std::string hardware_failure_profile = j["hardware_failure_profile"];
+  // Resubmit the jobs failed by a hardware failure up to this number of times
+  size_t max_job_requeues              = j.value("max_job_requeues", 1);
+  // Failure detector run by the heartbeat monitor agents: all-to-all heartbeats, or SWIM probes with this fanout
+  std::string failure_detector         = j.value("failure_detector", "heartbeat");
+  size_t swim_fanout                   = j.value("swim_fanout", 3);
+  double swim_probe_timeout            = j.value("swim_probe_timeout", heartbeat_period / 2);
+  if ((failure_detector != "heartbeat" && failure_detector != "swim") || swim_probe_timeout <= 0 ||
+      swim_probe_timeout >= heartbeat_period) {
+    std::cerr << "Invalid failure_detector (expected \"heartbeat\" or \"swim\") or swim_probe_timeout (expected "
+              << "between 0 and heartbeat_period): " << failure_detector << ", " << swim_probe_timeout << std::endl;
+    exit(1);
+  }
+  // Heartbeat period of the monitors: fixed, stretched up to heartbeat_max_period while nothing happens, or no monitors
+  std::string heartbeat_mode  = j.value("heartbeat_mode", "periodic");
+  double heartbeat_max_period = j.value("heartbeat_max_period", 64 * heartbeat_period);
+  if ((heartbeat_mode != "periodic" && heartbeat_mode != "adaptive" && heartbeat_mode != "disabled") ||
+      (heartbeat_mode == "disabled" && not hardware_failure_profile.empty()) ||
+      heartbeat_max_period < heartbeat_period) {
+    std::cerr << "Invalid heartbeat_mode (expected \"periodic\", \"adaptive\", or \"disabled\" without "
+              << "hardware_failure_profile) or heartbeat_max_period (expected at least heartbeat_period): "
+              << heartbeat_mode << ", " << heartbeat_max_period << std::endl;
+    exit(1);
+  }
 
   // Initialize the simulation.
   auto simulation = wrench::Simulation::createSimulation();
@@ -86,6 +184,29 @@ int main(int argc, char** argv)
   // Create the networks of job scheduling and hearbeat monitor agents
   std::vector<std::shared_ptr<wrench::JobSchedulingAgent>> job_scheduling_agent_network;
   std::vector<std::shared_ptr<wrench::HeartbeatMonitorAgent>> heartbeat_monitor_agent_network;
+  std::shared_ptr<BidderBackend> shared_bidder_backend;
+  if (not centralized_submission && not decentralized_bidder.empty() && bidder_pool_shared)
+    shared_bidder_backend = BidderBackend::create(bidder_backend, decentralized_bidder, bidder_pool_size);
+  std::shared_ptr<BidJournal> bid_journal;
+  if (not bid_journal_file.empty())
+    bid_journal = std::make_shared<BidJournal>(bid_journal_file, BidJournal::string_to_mode(bid_journal_mode));
+  std::shared_ptr<BidDispatcher> bid_dispatcher;
+  std::shared_ptr<BidPrefetcher> bid_prefetcher;
+  if (not centralized_submission && (bid_dispatch_threads > 0 || bid_prefetch_lookahead > 0))
+    bid_dispatcher = std::make_shared<BidDispatcher>(bid_dispatch_threads);
+  if (not centralized_submission && bid_prefetch_lookahead > 0)
+    bid_prefetcher = std::make_shared<BidPrefetcher>(bid_dispatcher, bid_prefetch_lookahead);
+  std::shared_ptr<MessageOutbox> workload_outbox;
+  if (coalesce_messages && not centralized_submission) {
+    workload_outbox = std::make_shared<MessageOutbox>();
+    workload_outbox->set_coalescing(true);
+  }
+  std::shared_ptr<SystemStatusBoard> status_board;
+  if (status_board_enabled)
+    status_board = std::make_shared<SystemStatusBoard>(status_board_strict);
+  std::shared_ptr<BidCache> bid_cache;
+  if (not centralized_submission && bid_cache_config.is_object())
+    bid_cache = std::make_shared<BidCache>(bid_cache_config);
   for (const auto& [system_name, host_list] : wrench::Simulation::getHostnameListByCluster()) {
     // Create the HPCSystemDescription
     auto system_description = HPCSystemDescription::create(system_name, host_list);
@@ -99,10 +220,18 @@ int main(int argc, char** argv)
 
     // Create a Scheduling Policy for this simulation run
     // In centralized mode, use PureLocal since the centralized agent already made the decision
+    std::shared_ptr<BidderBackend> agent_bidder_backend = shared_bidder_backend;
+    if (not centralized_submission && not decentralized_bidder.empty() && not agent_bidder_backend)
+      agent_bidder_backend = BidderBackend::create(bidder_backend, decentralized_bidder, bidder_pool_size);
     auto scheduling_policy =
         centralized_submission ? SchedulingPolicy::create_scheduling_policy("PureLocal", "")
                    : SchedulingPolicy::create_scheduling_policy(decentralized_policy, decentralized_bidder,
-                                         bidder_prompt_file);
+                                         bidder_prompt_file, agent_bidder_backend, bid_journal);
+    if (bid_aggregation == "tree")
+      scheduling_policy->set_bid_aggregation(SchedulingPolicy::BidAggregation::TREE, bid_aggregation_arity);
+    else if (bid_aggregation == "site")
+      scheduling_policy->set_bid_aggregation(SchedulingPolicy::BidAggregation::SITE, bid_aggregation_arity);
+    scheduling_policy->set_feasibility_prefilter(feasibility_prefilter, exclude_infeasible_bidders);
 
     // Instantiate a job scheduling agent on the head node of this HPC system
     auto new_agent = simulation->add(
@@ -110,13 +239,37 @@ int main(int argc, char** argv)
     new_agent->setDaemonized(true);
     // Allow this agent to notify the job lifecycle tracker
     new_agent->set_job_lifecycle_tracker(job_lifecycle_tracker_agent);
+    // Let this agent run its external bidder concurrently with those of the other agents
+    if (bid_dispatch_threads > 0)
+      new_agent->set_bid_dispatcher(bid_dispatcher);
+    new_agent->set_bid_prefetcher(bid_prefetcher);
+    new_agent->set_bid_cache(bid_cache);
+    new_agent->set_idle_node_check(check_idle_nodes);
+    new_agent->set_status_board(status_board);
+    new_agent->set_message_coalescing(coalesce_messages);
+    new_agent->set_auction_deadline(auction_deadline, auction_quorum);
+    new_agent->set_max_job_requeues(max_job_requeues);
+    if (cache_start_time_estimates)
+      new_agent->set_start_time_estimate_cache(std::make_shared<StartTimeEstimateCache>());
+    if (start_time_estimator == "profile")
+      new_agent->set_availability_profile(std::make_shared<AvailabilityProfile>(system_description->get_num_nodes()),
+                                          validate_start_time_estimator);
     // Add the new agent to the network
     job_scheduling_agent_network.push_back(new_agent);
 
+    // Without hardware failures, there is nothing to monitor
+    if (heartbeat_mode == "disabled")
+      continue;
+
     // Instantiate a heartbeat monitor agent on the head node of this HPC system
     auto new_hb_agent = simulation->add(
         new wrench::HeartbeatMonitorAgent(head_node, new_agent, heartbeat_period, heartbeat_expiration));
     new_hb_agent->setDaemonized(true);
+    if (failure_detector == "swim")
+      new_hb_agent->set_failure_detector(wrench::HeartbeatMonitorAgent::FailureDetector::SWIM, swim_fanout,
+                                         swim_probe_timeout);
+    if (heartbeat_mode == "adaptive")
+      new_hb_agent->set_adaptive_period(heartbeat_max_period);
     // Attach the heartbeat monitor to the job scheduling agent
     new_agent->set_heartbeat_monitor(new_hb_agent);
     // Add the new agent to the network
@@ -133,21 +286,139 @@ int main(int argc, char** argv)
       if (src != dst)
         src->add_heartbeat_monitor_agent(dst);
 
+  // Instantiate a resource switching agent that will inject the hardware failures of the profile, if any
+  std::shared_ptr<wrench::ResourceSwitchingAgent> resource_switching_agent;
+  if (not hardware_failure_profile.empty()) {
+    resource_switching_agent = simulation->add(new wrench::ResourceSwitchingAgent(
+        "ASCR.doe.gov", wrench::Simulation::getHostnameListByCluster(), hardware_failure_profile));
+    resource_switching_agent->setDaemonized(true);
+    resource_switching_agent->set_job_scheduling_agent_network(job_scheduling_agent_network);
+  }
+
   // Instantiate a workload submission agent that will generate jobs and assign jobs to scheduling agents
+  std::shared_ptr<CentralizedSchedulingPolicy> centralized_scheduling_policy;
   if (centralized_submission) {
-    auto centralized_scheduling_policy = std::make_shared<CentralizedSchedulingPolicy>(centralized_policy);
-    auto workload_submission_agent     = simulation->add(new wrench::WorkloadCentralizedSubmissionAgent(
+    std::shared_ptr<BidderBackend> centralized_bidder_backend;
+    if (centralized_batched_bids)
+      centralized_bidder_backend = BidderBackend::create(bidder_backend, centralized_policy, bidder_pool_size);
+    centralized_scheduling_policy =
+        std::make_shared<CentralizedSchedulingPolicy>(centralized_policy, centralized_bidder_backend, bid_journal);
+    centralized_scheduling_policy->set_feasibility_prefilter(feasibility_prefilter);
+    auto workload_submission_agent = simulation->add(new wrench::WorkloadCentralizedSubmissionAgent(
         "ASCR.doe.gov", workload, job_scheduling_agent_network, centralized_scheduling_policy));
     workload_submission_agent->set_job_lifecycle_tracker(job_lifecycle_tracker_agent);
   } else {
     auto workload_submission_agent =
         simulation->add(new wrench::WorkloadSubmissionAgent("ASCR.doe.gov", workload, job_scheduling_agent_network));
     workload_submission_agent->set_job_lifecycle_tracker(job_lifecycle_tracker_agent);
+    workload_submission_agent->set_bid_prefetcher(bid_prefetcher);
+    workload_submission_agent->set_message_outbox(workload_outbox);
   }
 
   // Launch the simulation. This call only returns when the simulation is complete
   try {
     simulation->launch();
+    if (bid_journal)
+      WRENCH_INFO("Bid journal %s: %zu bids recorded, %zu bids replayed, %zu input mismatches",
+                  bid_journal_file.c_str(), bid_journal->get_num_recorded_bids(), bid_journal->get_num_replayed_bids(),
+                  bid_journal->get_num_mismatches());
+    if (bid_prefetcher)
+      WRENCH_INFO("Bid prefetching: %zu bids prefetched, %zu hits, %zu misses, %zu evicted unused (%zu not computed)",
+                  bid_prefetcher->get_num_prefetched_bids(), bid_prefetcher->get_num_hits(),
+                  bid_prefetcher->get_num_misses(), bid_prefetcher->get_num_evictions(),
+                  bid_prefetcher->get_num_cancellations());
+    if (check_idle_nodes)
+      for (const auto& agent : job_scheduling_agent_network)
+        WRENCH_INFO("Idle nodes of %s: %zu inconsistencies with the batch compute service",
+                    agent->get_hpc_system_name().c_str(), agent->get_num_idle_node_inconsistencies());
+    for (const auto& agent : job_scheduling_agent_network)
+      if (const auto& cache = agent->get_start_time_estimate_cache())
+        WRENCH_INFO("Start time estimates on %s: %zu requested, %zu served from cache, %zu estimator calls "
+                    "(%zu invalidations)",
+                    agent->get_hpc_system_name().c_str(), cache->get_num_requests(), cache->get_num_hits(),
+                    cache->get_num_estimator_calls(), cache->get_num_invalidations());
+    if (validate_start_time_estimator)
+      for (const auto& agent : job_scheduling_agent_network)
+        if (const auto& profile = agent->get_availability_profile())
+          WRENCH_INFO("Availability profile of %s: %zu/%zu start time estimates diverge from the batch compute "
+                      "service (max divergence: %f s)",
+                      agent->get_hpc_system_name().c_str(), profile->get_num_divergent_estimates(),
+                      profile->get_num_validated_estimates(), profile->get_max_divergence());
+    if (not centralized_submission) {
+      size_t num_bid_messages = 0, num_wide_area_bid_messages = 0;
+      for (const auto& agent : job_scheduling_agent_network) {
+        num_bid_messages += agent->get_scheduling_policy()->get_num_bid_messages();
+        num_wide_area_bid_messages += agent->get_scheduling_policy()->get_num_wide_area_bid_messages();
+      }
+      WRENCH_INFO("Bid exchange (%s): %zu messages between agents, %zu of which across sites", bid_aggregation.c_str(),
+                  num_bid_messages, num_wide_area_bid_messages);
+      size_t num_auctions_closed_on_deadline = 0, num_auctions_closed_on_failure = 0;
+      for (const auto& agent : job_scheduling_agent_network) {
+        num_auctions_closed_on_deadline += agent->get_num_auctions_closed_on_deadline();
+        num_auctions_closed_on_failure += agent->get_num_auctions_closed_on_failure();
+      }
+      WRENCH_INFO("Auctions closed early: %zu on their deadline, %zu upon a failure notification",
+                  num_auctions_closed_on_deadline, num_auctions_closed_on_failure);
+      if (feasibility_prefilter) {
+        size_t num_prefiltered_bids = 0, num_excluded_bidders = 0;
+        for (const auto& agent : job_scheduling_agent_network) {
+          num_prefiltered_bids += agent->get_num_prefiltered_bids();
+          num_excluded_bidders += agent->get_num_excluded_bidders();
+        }
+        WRENCH_INFO("Feasibility prefilter: %zu null bids computed natively, %zu job requests not sent",
+                    num_prefiltered_bids, num_excluded_bidders);
+      }
+    } else if (feasibility_prefilter) {
+      WRENCH_INFO("Feasibility prefilter: %zu null bids computed natively",
+                  centralized_scheduling_policy->get_num_prefiltered_bids());
+    }
+    auto num_jobs = job_lifecycle_tracker_agent->get_num_jobs();
+    WRENCH_INFO("Control messages: %zu allocations (%.1f per job), %zu of which from the heap",
+                MessagePoolStats::num_allocations,
+                num_jobs ? static_cast<double>(MessagePoolStats::num_allocations) / num_jobs : 0.0,
+                MessagePoolStats::num_heap_allocations);
+    if (workload_outbox) {
+      size_t num_messages = workload_outbox->get_num_messages();
+      size_t num_sent     = workload_outbox->get_num_sent_messages();
+      for (const auto& agent : job_scheduling_agent_network) {
+        num_messages += agent->get_scheduling_policy()->get_outbox().get_num_messages();
+        num_sent += agent->get_scheduling_policy()->get_outbox().get_num_sent_messages();
+      }
+      WRENCH_INFO("Message coalescing: %zu job requests and bids sent in %zu messages", num_messages, num_sent);
+    }
+    if (resource_switching_agent) {
+      size_t num_requeued_jobs = 0;
+      for (const auto& agent : job_scheduling_agent_network)
+        num_requeued_jobs += agent->get_num_requeued_jobs();
+      WRENCH_INFO("Hardware failures: %zu events, %zu compute nodes turned off, %zu jobs requeued",
+                  resource_switching_agent->get_num_failure_events(),
+                  resource_switching_agent->get_num_node_failures(), num_requeued_jobs);
+    }
+    if (heartbeat_mode != "disabled") {
+      size_t num_detector_periods = 0, num_detector_messages = 0, num_detections = 0, num_false_detections = 0;
+      double total_detection_latency = 0, max_detection_latency = 0;
+      for (const auto& monitor : heartbeat_monitor_agent_network) {
+        num_detector_periods += monitor->get_num_periods();
+        num_detector_messages += monitor->get_num_sent_messages();
+        num_detections += monitor->get_num_detections();
+        num_false_detections += monitor->get_num_false_detections();
+        total_detection_latency += monitor->get_total_detection_latency();
+        max_detection_latency = std::max(max_detection_latency, monitor->get_max_detection_latency());
+      }
+      auto num_true_detections = num_detections - num_false_detections;
+      WRENCH_INFO("Failure detector (%s, %s period): %zu periods, %zu messages, %zu detections (%zu false), "
+                  "detection latency %.2f s on average, %.2f s at most",
+                  failure_detector.c_str(), heartbeat_mode.c_str(), num_detector_periods, num_detector_messages,
+                  num_detections, num_false_detections,
+                  num_true_detections ? total_detection_latency / num_true_detections : 0.0, max_detection_latency);
+    }
+    if (status_board)
+      WRENCH_INFO("Status board: %zu snapshots published, %zu reads", status_board->get_num_publications(),
+                  status_board->get_num_reads());
+    if (bid_cache)
+      WRENCH_INFO("Bid cache: %zu entries, %zu hits, %zu misses, %zu revalidations, %zu error bound violations",
+                  bid_cache->get_num_entries(), bid_cache->get_num_hits(), bid_cache->get_num_misses(),
+                  bid_cache->get_num_revalidations(), bid_cache->get_num_violations());
     return 0;
   } catch (std::runtime_error& e) {
     std::cerr << "Exception: " << e.what() << std::endl;
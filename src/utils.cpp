@@ -2,6 +2,8 @@
 #include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
+#include <random>
+#include <regex>
 
 #include "agents/JobSchedulingAgent.h"
 #include "info/HPCSystemDescription.h"
@@ -75,6 +77,24 @@ double get_job_start_time_estimate_on(const std::shared_ptr<JobDescription>& job
   return current_job_start_time_estimate.begin()->second;
 }
 
+std::map<std::pair<size_t, sg_size_t>, double>
+get_job_start_time_estimates_on(const std::set<std::pair<size_t, sg_size_t>>& job_shapes,
+                                const std::shared_ptr<wrench::BatchComputeService>& batch)
+{
+  // Fake a Wrench job per shape, named after its position in the set
+  std::set<std::tuple<std::string, unsigned long, unsigned long, sg_size_t>> wrench_job_descriptions;
+  size_t index = 0;
+  for (const auto& [num_nodes, walltime] : job_shapes)
+    wrench_job_descriptions.insert({std::to_string(index++), num_nodes, 1 /*num_cores*/, walltime});
+  auto start_time_estimates = batch->getStartTimeEstimates(wrench_job_descriptions);
+
+  std::map<std::pair<size_t, sg_size_t>, double> result;
+  index = 0;
+  for (const auto& job_shape : job_shapes)
+    result[job_shape] = start_time_estimates.at(std::to_string(index++));
+  return result;
+}
+
 size_t get_queue_length(const std::shared_ptr<wrench::BatchComputeService>& batch)
 {
   return batch->getQueue().size();
@@ -94,7 +114,8 @@ int do_not_pass_acceptance_tests(const std::shared_ptr<JobDescription>& job_desc
       (hpc_system_description->get_num_nodes() * hpc_system_description->get_memory_amount_in_gb()))
     do_pass = 3;
 
-  // TODO add test for storage
+  if (job_description->get_requested_storage_gb() > hpc_system_description->get_storage_amount_in_gb())
+    do_pass = 4;
 
   return do_pass;
 }
@@ -111,11 +132,35 @@ std::string get_failure_cause_as_string(int failure_code)
     case 3:
       return "Job requires more memory than the System has";
       break;
+    case 4:
+      return "Job requires more storage than the System has";
+      break;
     default:
       return "Unknown failure code";
   }
 }
 
+bool declares_zero_bids_on_infeasible_jobs(const std::string& python_script_name)
+{
+  static const std::regex declaration(R"(^BIDS_ZERO_ON_INFEASIBLE_JOBS\s*=\s*True\b)");
+  std::ifstream script(python_script_name);
+  std::string line;
+  while (std::getline(script, line))
+    if (std::regex_search(line, declaration))
+      return true;
+  return false;
+}
+
+double get_tie_breaker(int job_id, const std::string& hpc_system_name)
+{
+  constexpr uint64_t SEED = 42;
+  auto job_id_val         = static_cast<uint64_t>(job_id);
+  uint64_t mixed          = SEED ^ (job_id_val * 6364136223846793005ULL) ^ std::hash<std::string>{}(hpc_system_name);
+  std::mt19937_64 gen(mixed);
+  std::uniform_real_distribution<double> dis(0.0, 100.0);
+  return dis(gen);
+}
+
 std::string
 get_all_bids_as_string(const std::map<std::shared_ptr<wrench::JobSchedulingAgent>, std::pair<double, double>>& all_bids)
 {
@@ -0,0 +1,235 @@
+#include "utils/AvailabilityProfile.h"
+
+#include <algorithm>
+#include <cmath>
+
+void AvailabilityProfile::add_queued_job(int job_id, size_t num_nodes, double walltime)
+{
+  jobs_[job_id] = {num_nodes, walltime, -1};
+  queued_jobs_.push_back(job_id);
+  outdated_ = true;
+}
+
+void AvailabilityProfile::start_job(int job_id, double start_time)
+{
+  auto it = jobs_.find(job_id);
+  if (it == jobs_.end())
+    return;
+  it->second.start_time = start_time;
+  queued_jobs_.erase(std::remove(queued_jobs_.begin(), queued_jobs_.end(), job_id), queued_jobs_.end());
+  outdated_ = true;
+}
+
+void AvailabilityProfile::remove_job(int job_id)
+{
+  if (jobs_.erase(job_id) == 0)
+    return;
+  queued_jobs_.erase(std::remove(queued_jobs_.begin(), queued_jobs_.end(), job_id), queued_jobs_.end());
+  outdated_ = true;
+}
+
+void AvailabilityProfile::set_num_off_nodes(size_t num_off_nodes)
+{
+  num_off_nodes_ = std::min(num_off_nodes, num_nodes_);
+  outdated_      = true;
+}
+
+int AvailabilityProfile::new_step(double date, int64_t free_nodes)
+{
+  steps_.push_back({date, free_nodes, free_nodes, free_nodes, 0, static_cast<uint32_t>(priorities_())});
+  return static_cast<int>(steps_.size()) - 1;
+}
+
+void AvailabilityProfile::add(int step, int64_t delta)
+{
+  if (step < 0)
+    return;
+  steps_[step].free_nodes += delta;
+  steps_[step].min_free_nodes += delta;
+  steps_[step].max_free_nodes += delta;
+  steps_[step].pending_delta += delta;
+}
+
+void AvailabilityProfile::push(int step)
+{
+  if (steps_[step].pending_delta == 0)
+    return;
+  add(steps_[step].left, steps_[step].pending_delta);
+  add(steps_[step].right, steps_[step].pending_delta);
+  steps_[step].pending_delta = 0;
+}
+
+void AvailabilityProfile::pull(int step)
+{
+  auto& s          = steps_[step];
+  s.min_free_nodes = s.max_free_nodes = s.free_nodes;
+  for (auto child : {s.left, s.right}) {
+    if (child < 0)
+      continue;
+    s.min_free_nodes = std::min(s.min_free_nodes, steps_[child].min_free_nodes);
+    s.max_free_nodes = std::max(s.max_free_nodes, steps_[child].max_free_nodes);
+  }
+}
+
+void AvailabilityProfile::split(int step, double date, int& before, int& from)
+{
+  if (step < 0) {
+    before = from = -1;
+    return;
+  }
+  push(step);
+  if (steps_[step].date < date) {
+    split(steps_[step].right, date, steps_[step].right, from);
+    before = step;
+  } else {
+    split(steps_[step].left, date, before, steps_[step].left);
+    from = step;
+  }
+  pull(step);
+}
+
+int AvailabilityProfile::merge(int before, int after)
+{
+  if (before < 0)
+    return after;
+  if (after < 0)
+    return before;
+  if (steps_[before].priority > steps_[after].priority) {
+    push(before);
+    steps_[before].right = merge(steps_[before].right, after);
+    pull(before);
+    return before;
+  }
+  push(after);
+  steps_[after].left = merge(before, steps_[after].left);
+  pull(after);
+  return after;
+}
+
+int64_t AvailabilityProfile::get_free_nodes(double date)
+{
+  // The step in effect at date is the last one starting at or before it
+  int64_t free_nodes = 0;
+  for (auto step = root_; step >= 0;) {
+    push(step);
+    if (steps_[step].date <= date) {
+      free_nodes = steps_[step].free_nodes;
+      step       = steps_[step].right;
+    } else {
+      step = steps_[step].left;
+    }
+  }
+  return free_nodes;
+}
+
+void AvailabilityProfile::add_step(double date)
+{
+  for (auto step = root_; step >= 0; step = date < steps_[step].date ? steps_[step].left : steps_[step].right)
+    if (steps_[step].date == date)
+      return;
+  auto step = new_step(date, get_free_nodes(date));
+  int before, from;
+  split(root_, date, before, from);
+  root_ = merge(merge(before, step), from);
+}
+
+double AvailabilityProfile::find_first_fitting(int step, double from, int64_t num_nodes)
+{
+  // Date of the first step starting at or after from with at least num_nodes free nodes, or -1
+  if (step < 0 || steps_[step].max_free_nodes < num_nodes)
+    return -1;
+  push(step);
+  if (steps_[step].date < from)
+    return find_first_fitting(steps_[step].right, from, num_nodes);
+  auto date = find_first_fitting(steps_[step].left, from, num_nodes);
+  if (date >= 0)
+    return date;
+  if (steps_[step].free_nodes >= num_nodes)
+    return steps_[step].date;
+  return find_first_fitting(steps_[step].right, from, num_nodes);
+}
+
+double AvailabilityProfile::find_first_blocking(int step, double after, double before, int64_t num_nodes)
+{
+  // Date of the first step strictly between after and before with less than num_nodes free nodes, or -1
+  if (step < 0 || steps_[step].min_free_nodes >= num_nodes)
+    return -1;
+  push(step);
+  if (steps_[step].date <= after)
+    return find_first_blocking(steps_[step].right, after, before, num_nodes);
+  if (steps_[step].date >= before)
+    return find_first_blocking(steps_[step].left, after, before, num_nodes);
+  auto date = find_first_blocking(steps_[step].left, after, before, num_nodes);
+  if (date >= 0)
+    return date;
+  if (steps_[step].free_nodes < num_nodes)
+    return steps_[step].date;
+  return find_first_blocking(steps_[step].right, after, before, num_nodes);
+}
+
+double AvailabilityProfile::find_earliest_start_time(size_t num_nodes, double walltime, double not_before)
+{
+  if (num_nodes > num_nodes_ - num_off_nodes_)
+    return -1;
+
+  // Jump from a step with enough free nodes to the first step blocking the job before the end of its walltime, then to
+  // the first step with enough free nodes after it, until the job fits. The profile begins at the date it was built.
+  auto needed_nodes = static_cast<int64_t>(num_nodes);
+  auto candidate =
+    get_free_nodes(not_before) >= needed_nodes ? not_before : find_first_fitting(root_, not_before, needed_nodes);
+  while (candidate >= 0) {
+    auto blocking_date = find_first_blocking(root_, candidate, candidate + walltime, needed_nodes);
+    if (blocking_date < 0)
+      return candidate;
+    candidate = find_first_fitting(root_, blocking_date, needed_nodes);
+  }
+  return -1; // Cannot happen, all nodes are eventually free
+}
+
+void AvailabilityProfile::reserve(double start_time, double walltime, size_t num_nodes)
+{
+  auto end_time = start_time + walltime;
+  // Split the steps at both ends of the reservation, then take the nodes from the steps in between
+  add_step(start_time);
+  add_step(end_time);
+  int before, rest, during, after;
+  split(root_, start_time, before, rest);
+  split(rest, end_time, during, after);
+  add(during, -static_cast<int64_t>(num_nodes));
+  root_ = merge(merge(before, during), after);
+}
+
+void AvailabilityProfile::build(double current_simulated_time)
+{
+  steps_.clear();
+  root_ = new_step(current_simulated_time, static_cast<int64_t>(num_nodes_ - num_off_nodes_));
+  // Running jobs keep their nodes until the end of their requested walltime
+  for (const auto& [job_id, job] : jobs_)
+    if (job.start_time >= 0 && job.start_time + job.walltime > current_simulated_time)
+      reserve(current_simulated_time, job.start_time + job.walltime - current_simulated_time, job.num_nodes);
+  // Queued jobs are reserved in submission order, at the earliest date they fit (conservative backfilling)
+  for (auto job_id : queued_jobs_) {
+    const auto& job = jobs_.at(job_id);
+    auto start_time = find_earliest_start_time(job.num_nodes, job.walltime, current_simulated_time);
+    if (start_time >= 0)
+      reserve(start_time, job.walltime, job.num_nodes);
+  }
+  outdated_ = false;
+}
+
+double AvailabilityProfile::get_start_time_estimate(size_t num_nodes, double walltime, double current_simulated_time)
+{
+  // Reservations only change upon job events, the profile thus remains valid as time goes by
+  if (outdated_)
+    build(current_simulated_time);
+  return find_earliest_start_time(num_nodes, walltime, current_simulated_time);
+}
+
+void AvailabilityProfile::validate(double start_time_estimate, double batch_start_time_estimate)
+{
+  auto divergence = std::fabs(start_time_estimate - batch_start_time_estimate);
+  num_validated_estimates_++;
+  if (divergence > 1e-6)
+    num_divergent_estimates_++;
+  max_divergence_ = std::max(max_divergence_, divergence);
+}
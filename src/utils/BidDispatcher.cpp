@@ -0,0 +1,87 @@
+#include "utils/BidDispatcher.h"
+
+#include <algorithm>
+
+BidDispatcher::BidDispatcher(size_t num_threads)
+{
+  for (size_t i = 0; i < std::max<size_t>(1, num_threads); i++)
+    threads_.emplace_back(&BidDispatcher::run_tasks, this);
+}
+
+BidDispatcher::~BidDispatcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    // Nobody waits for the bids that were not computed yet anymore, only those being computed are completed
+    tasks_.clear();
+    background_tasks_.clear();
+  }
+  task_available_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+void BidDispatcher::run_tasks()
+{
+  while (true) {
+    std::packaged_task<nlohmann::json()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      task_available_.wait(lock,
+                           [this] { return stopping_ || not tasks_.empty() || not background_tasks_.empty(); });
+      if (not tasks_.empty()) {
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      } else if (not background_tasks_.empty()) {
+        task = std::move(background_tasks_.front().task);
+        background_tasks_.pop_front();
+      } else {
+        return; // stopping
+      }
+    }
+    // Exceptions thrown by the bidder are stored in the future and rethrown in the simulation thread
+    task();
+  }
+}
+
+std::future<nlohmann::json> BidDispatcher::dispatch(std::function<nlohmann::json()> external_bid)
+{
+  std::packaged_task<nlohmann::json()> task(std::move(external_bid));
+  auto result = task.get_future();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  task_available_.notify_one();
+  num_dispatched_bids_++;
+  return result;
+}
+
+std::pair<size_t, std::future<nlohmann::json>>
+BidDispatcher::dispatch_in_background(std::function<nlohmann::json()> external_bid)
+{
+  std::packaged_task<nlohmann::json()> task(std::move(external_bid));
+  auto result = task.get_future();
+  size_t id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    id = next_background_task_id_++;
+    background_tasks_.push_back({id, std::move(task)});
+  }
+  task_available_.notify_one();
+  num_dispatched_bids_++;
+  return {id, std::move(result)};
+}
+
+bool BidDispatcher::cancel(size_t background_task_id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Ids are increasing along the queue
+  auto it = std::lower_bound(background_tasks_.begin(), background_tasks_.end(), background_task_id,
+                             [](const BackgroundTask& task, size_t id) { return task.id < id; });
+  if (it == background_tasks_.end() || it->id != background_task_id)
+    return false;
+  background_tasks_.erase(it);
+  return true;
+}
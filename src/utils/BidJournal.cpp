@@ -0,0 +1,129 @@
+#include "utils/BidJournal.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <xbt/log.h>
+
+XBT_LOG_EXTERNAL_CATEGORY(swarm_dmas);
+
+namespace {
+
+// File format (host byte order): MAGIC, FORMAT_VERSION as a uint32, then one record per bid made of an int32 job id, a
+// uint16 length and the characters of the system name, a uint64 input hash, and two doubles for the bid and its
+// bid_generation_time_seconds
+constexpr char MAGIC[4]           = {'S', 'W', 'B', 'J'};
+constexpr uint32_t FORMAT_VERSION = 1;
+
+template <typename T>
+void write_value(std::ofstream& out, const T& value)
+{
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_value(std::ifstream& in, T& value)
+{
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+} // namespace
+
+BidJournal::BidJournal(const std::string& file_name, Mode mode) : file_name_(file_name), mode_(mode)
+{
+  if (mode_ == Mode::REPLAY) {
+    load();
+    return;
+  }
+
+  output_.open(file_name_, std::ios::binary | std::ios::trunc);
+  if (not output_.is_open())
+    throw std::runtime_error("Failed to create bid journal: " + file_name_);
+  output_.write(MAGIC, sizeof(MAGIC));
+  write_value(output_, FORMAT_VERSION);
+  output_.flush();
+}
+
+BidJournal::Mode BidJournal::string_to_mode(const std::string& s)
+{
+  if (s == "record")
+    return Mode::RECORD;
+  if (s == "replay")
+    return Mode::REPLAY;
+  throw std::invalid_argument("Invalid bid journal mode (expected \"record\" or \"replay\"): " + s);
+}
+
+uint64_t BidJournal::hash_input(const nlohmann::json& input)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : input.dump()) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+void BidJournal::load()
+{
+  std::ifstream input(file_name_, std::ios::binary);
+  if (not input.is_open())
+    throw std::runtime_error("Failed to open bid journal: " + file_name_);
+
+  char magic[sizeof(MAGIC)];
+  uint32_t version;
+  if (not input.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      not read_value(input, version))
+    throw std::runtime_error("Not a bid journal: " + file_name_);
+  if (version != FORMAT_VERSION)
+    throw std::runtime_error("Unsupported bid journal version " + std::to_string(version) + ": " + file_name_);
+
+  int32_t job_id;
+  while (read_value(input, job_id)) {
+    uint16_t name_length;
+    std::string system_name;
+    Entry entry;
+    bool complete = read_value(input, name_length);
+    if (complete) {
+      system_name.resize(name_length);
+      complete = input.read(system_name.data(), name_length) && read_value(input, entry.input_hash) &&
+                 read_value(input, entry.bid) && read_value(input, entry.bid_generation_time);
+    }
+    // A run interrupted while recording may leave a truncated last record
+    if (not complete) {
+      XBT_CWARN(swarm_dmas, "Ignoring a truncated record at the end of bid journal %s", file_name_.c_str());
+      break;
+    }
+    recorded_bids_[{job_id, system_name}].push_back(entry);
+  }
+}
+
+void BidJournal::record(int job_id, const std::string& system_name, uint64_t input_hash, double bid,
+                        double bid_generation_time)
+{
+  write_value(output_, static_cast<int32_t>(job_id));
+  write_value(output_, static_cast<uint16_t>(system_name.size()));
+  output_.write(system_name.data(), static_cast<std::streamsize>(system_name.size()));
+  write_value(output_, input_hash);
+  write_value(output_, bid);
+  write_value(output_, bid_generation_time);
+  // Bids are expensive: keep what was recorded so far if the simulation does not terminate
+  output_.flush();
+  num_recorded_bids_++;
+}
+
+std::pair<double, double> BidJournal::replay(int job_id, const std::string& system_name, uint64_t input_hash)
+{
+  auto it = recorded_bids_.find({job_id, system_name});
+  if (it == recorded_bids_.end() || it->second.empty())
+    throw std::runtime_error("No bid recorded in " + file_name_ + " for Job #" + std::to_string(job_id) + " on " +
+                             system_name);
+
+  auto entry = it->second.front();
+  it->second.pop_front();
+  num_replayed_bids_++;
+  if (entry.input_hash != input_hash) {
+    num_mismatches_++;
+    XBT_CWARN(swarm_dmas, "Bid journal mismatch for Job #%d on %s: the bidder input differs from the recorded one",
+              job_id, system_name.c_str());
+  }
+  return {entry.bid, entry.bid_generation_time};
+}
@@ -0,0 +1,18 @@
+#include "utils/BidderBackend.h"
+#include "utils/BidderWorkerPool.h"
+#include "utils/EmbeddedPythonBidder.h"
+
+#include <stdexcept>
+
+std::shared_ptr<BidderBackend> BidderBackend::create(const std::string& backend_name,
+                                                     const std::string& python_script_name, size_t pool_size)
+{
+  if (backend_name == "fork")
+    return std::make_shared<ForkBidderBackend>(python_script_name);
+  else if (backend_name == "pool")
+    return std::make_shared<BidderWorkerPool>(python_script_name, pool_size);
+  else if (backend_name == "embedded")
+    return std::make_shared<EmbeddedPythonBidderBackend>(python_script_name);
+  else
+    throw std::invalid_argument("Unknown bidder backend: " + backend_name);
+}
@@ -0,0 +1,264 @@
+#include "utils/BidderWorkerPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+BidderWorkerPool::BidderWorkerPool(const std::string& python_script_name, size_t pool_size)
+    : python_script_name_(python_script_name), workers_(std::max<size_t>(1, pool_size))
+{
+  // The wrapper is deployed alongside the bidder scripts (see the swarm_dmas-python-scripts target)
+  worker_script_name_ = (std::filesystem::path(python_script_name_).parent_path() / "bidder_worker.py").string();
+
+  // Writing to a worker that just crashed must be reported as an error, not kill the simulator.
+  signal(SIGPIPE, SIG_IGN);
+
+  for (size_t i = 0; i < workers_.size(); i++)
+    idle_workers_.push_back(i);
+}
+
+BidderWorkerPool::~BidderWorkerPool()
+{
+  for (auto& worker : workers_)
+    stop_worker(worker);
+}
+
+void BidderWorkerPool::start_worker(Worker& worker)
+{
+  if (access(python_script_name_.c_str(), F_OK) != 0)
+    throw std::runtime_error("Python script not found: " + python_script_name_);
+  if (access(worker_script_name_.c_str(), F_OK) != 0)
+    throw std::runtime_error("Bidder worker wrapper not found: " + worker_script_name_);
+
+  int to_python[2];
+  int from_python[2];
+  if (pipe(to_python) == -1)
+    throw std::runtime_error("Failed to create pipes");
+  if (pipe(from_python) == -1) {
+    close(to_python[0]);
+    close(to_python[1]);
+    throw std::runtime_error("Failed to create pipes");
+  }
+  // Workers forked later must not inherit the pipes of this one, otherwise closing them would never deliver EOF.
+  for (int fd : {to_python[0], to_python[1], from_python[0], from_python[1]})
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  pid_t pid = fork();
+  if (pid == -1) {
+    for (int fd : {to_python[0], to_python[1], from_python[0], from_python[1]})
+      close(fd);
+    throw std::runtime_error("Failed to fork bidder worker");
+  }
+
+  if (pid == 0) {
+    // External Python process (dup2 clears FD_CLOEXEC on stdin/stdout)
+    dup2(to_python[0], STDIN_FILENO);
+    dup2(from_python[1], STDOUT_FILENO);
+    execlp("python3", "python3", worker_script_name_.c_str(), python_script_name_.c_str(), nullptr);
+    perror("execlp failed");
+    _exit(1);
+  }
+
+  close(to_python[0]);
+  close(from_python[1]);
+  worker.pid     = pid;
+  worker.to_fd   = to_python[1];
+  worker.from_fd = from_python[0];
+  worker.framed  = false;
+  worker.known_contexts.clear();
+  worker.pending_output.clear();
+
+  // A worker that does not understand the offer answers it with an error, as for any other invalid request. A worker
+  // that died meanwhile is detected (and restarted) upon the first request.
+  std::string answer;
+  worker.framed = send_request(worker, std::string(FRAMED_PROTOCOL) + "\n") && read_response(worker, answer) &&
+                  answer == FRAMED_PROTOCOL;
+}
+
+void BidderWorkerPool::stop_worker(Worker& worker)
+{
+  if (worker.pid == -1)
+    return;
+  // Closing its stdin makes a healthy worker leave its request loop and exit
+  close(worker.to_fd);
+  close(worker.from_fd);
+  waitpid(worker.pid, nullptr, 0);
+  worker.pid     = -1;
+  worker.to_fd   = -1;
+  worker.from_fd = -1;
+  worker.framed  = false;
+  worker.known_contexts.clear();
+  worker.pending_output.clear();
+}
+
+bool BidderWorkerPool::send_request(Worker& worker, const std::string& request)
+{
+  const char* data = request.data();
+  size_t remaining = request.size();
+  while (remaining > 0) {
+    ssize_t count = write(worker.to_fd, data, remaining);
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += count;
+    remaining -= count;
+  }
+  num_bytes_sent_ += request.size();
+  return true;
+}
+
+bool BidderWorkerPool::send_frame(Worker& worker, FrameType type, uint32_t context_id, const std::string& payload)
+{
+  // Header and payload are sent with a single write
+  std::string frame(FRAME_HEADER_SIZE, '\0');
+  uint32_t payload_size = payload.size();
+  std::memcpy(frame.data(), &payload_size, sizeof(payload_size));
+  frame[sizeof(payload_size)] = static_cast<char>(type);
+  std::memcpy(frame.data() + sizeof(payload_size) + 1, &context_id, sizeof(context_id));
+  frame += payload;
+  return send_request(worker, frame);
+}
+
+bool BidderWorkerPool::read_response(Worker& worker, std::string& response)
+{
+  char buffer[4096];
+  while (true) {
+    auto eol = worker.pending_output.find('\n');
+    if (eol != std::string::npos) {
+      response = worker.pending_output.substr(0, eol);
+      worker.pending_output.erase(0, eol + 1);
+      return true;
+    }
+    ssize_t count = read(worker.from_fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false; // The worker died or closed its stdout
+    worker.pending_output.append(buffer, count);
+  }
+}
+
+bool BidderWorkerPool::read_frame(Worker& worker, std::string& response)
+{
+  char buffer[4096];
+  while (true) {
+    if (worker.pending_output.size() >= FRAME_HEADER_SIZE) {
+      uint32_t payload_size;
+      std::memcpy(&payload_size, worker.pending_output.data(), sizeof(payload_size));
+      if (worker.pending_output[sizeof(payload_size)] != static_cast<char>(RESPONSE))
+        return false; // Out of sync with the worker, which is thus restarted
+      if (worker.pending_output.size() >= FRAME_HEADER_SIZE + payload_size) {
+        response = worker.pending_output.substr(FRAME_HEADER_SIZE, payload_size);
+        worker.pending_output.erase(0, FRAME_HEADER_SIZE + payload_size);
+        return true;
+      }
+    }
+    ssize_t count = read(worker.from_fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR)
+      continue;
+    if (count <= 0)
+      return false; // The worker died or closed its stdout
+    worker.pending_output.append(buffer, count);
+  }
+}
+
+bool BidderWorkerPool::exchange(Worker& worker, const nlohmann::json& input, uint32_t context_id,
+                                const Context* context, const std::string& request, std::string& response)
+{
+  if (not worker.framed) {
+    // dump() escapes newlines, a request is thus always a single line
+    if (not context)
+      return send_request(worker, request + "\n") && read_response(worker, response);
+    auto full_request = context->fields;
+    full_request.update(input);
+    return send_request(worker, full_request.dump() + "\n") && read_response(worker, response);
+  }
+  if (context && worker.known_contexts.count(context_id) == 0) {
+    if (not send_frame(worker, CONTEXT, context_id, context->payload))
+      return false;
+    worker.known_contexts.insert(context_id);
+  }
+  return send_frame(worker, REQUEST, context_id, request) && read_frame(worker, response);
+}
+
+uint32_t BidderWorkerPool::register_context(const nlohmann::json& context)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  contexts_.push_back({context, context.dump()});
+  // Ids start at 1, 0 stands for no context
+  return static_cast<uint32_t>(contexts_.size());
+}
+
+size_t BidderWorkerPool::acquire_worker()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  worker_released_.wait(lock, [this] { return not idle_workers_.empty(); });
+  auto index = idle_workers_.back();
+  idle_workers_.pop_back();
+  num_requests_++;
+  return index;
+}
+
+void BidderWorkerPool::release_worker(size_t index)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_workers_.push_back(index);
+  }
+  worker_released_.notify_one();
+}
+
+nlohmann::json BidderWorkerPool::run(const nlohmann::json& input)
+{
+  return run_in_context(input, 0);
+}
+
+nlohmann::json BidderWorkerPool::run_in_context(const nlohmann::json& input, uint32_t context_id)
+{
+  const Context* context = nullptr;
+  if (context_id != 0) {
+    // Elements of a deque do not move when others are registered
+    std::lock_guard<std::mutex> lock(mutex_);
+    context = &contexts_.at(context_id - 1);
+  }
+  std::string request = input.dump();
+
+  auto index   = acquire_worker();
+  auto& worker = workers_[index];
+  std::string response;
+  bool answered = false;
+  try {
+    // A crashed worker is restarted and the request retried once before giving up
+    for (int attempt = 0; attempt < 2 && not answered; attempt++) {
+      if (worker.pid == -1)
+        start_worker(worker);
+      answered = exchange(worker, input, context_id, context, request, response);
+      if (not answered) {
+        stop_worker(worker);
+        num_restarts_++;
+      }
+    }
+  } catch (...) {
+    release_worker(index);
+    throw;
+  }
+  release_worker(index);
+
+  if (not answered)
+    throw std::runtime_error("Bidder worker for " + python_script_name_ + " died twice on the same request");
+
+  try {
+    return nlohmann::json::parse(response);
+  } catch (const std::exception& e) {
+    throw std::runtime_error(std::string("Failed to parse Python response: ") + e.what() +
+                             "\nResponse was: " + response);
+  }
+}
@@ -0,0 +1,191 @@
+#include "utils/EmbeddedPythonBidder.h"
+
+#include <stdexcept>
+
+#ifdef ENABLE_EMBEDDED_PYTHON
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+std::mutex interpreter_mutex;
+// compute_bid functions of the already imported bidder scripts, indexed by script path
+std::unordered_map<std::string, PyObject*> compute_bid_functions;
+
+// RAII holder for the GIL, so that bidders can be called from any thread
+class GILGuard {
+  PyGILState_STATE state_;
+
+public:
+  GILGuard() : state_(PyGILState_Ensure()) {}
+  ~GILGuard() { PyGILState_Release(state_); }
+};
+
+std::string fetch_python_error()
+{
+  PyObject *type, *value, *traceback;
+  PyErr_Fetch(&type, &value, &traceback);
+  PyErr_NormalizeException(&type, &value, &traceback);
+  std::string message = "unknown Python error";
+  if (value) {
+    if (PyObject* str = PyObject_Str(value)) {
+      if (const char* utf8 = PyUnicode_AsUTF8(str))
+        message = utf8;
+      Py_DECREF(str);
+    }
+  }
+  Py_XDECREF(type);
+  Py_XDECREF(value);
+  Py_XDECREF(traceback);
+  return message;
+}
+
+// Returns a new reference
+PyObject* json_to_python(const nlohmann::json& j)
+{
+  switch (j.type()) {
+    case nlohmann::json::value_t::null:
+      Py_RETURN_NONE;
+    case nlohmann::json::value_t::boolean:
+      return PyBool_FromLong(j.get<bool>());
+    case nlohmann::json::value_t::number_integer:
+      return PyLong_FromLongLong(j.get<long long>());
+    case nlohmann::json::value_t::number_unsigned:
+      return PyLong_FromUnsignedLongLong(j.get<unsigned long long>());
+    case nlohmann::json::value_t::number_float:
+      return PyFloat_FromDouble(j.get<double>());
+    case nlohmann::json::value_t::string: {
+      const auto& s = j.get_ref<const std::string&>();
+      return PyUnicode_FromStringAndSize(s.data(), static_cast<Py_ssize_t>(s.size()));
+    }
+    case nlohmann::json::value_t::array: {
+      PyObject* list = PyList_New(static_cast<Py_ssize_t>(j.size()));
+      Py_ssize_t i   = 0;
+      for (const auto& item : j)
+        PyList_SET_ITEM(list, i++, json_to_python(item)); // steals the reference
+      return list;
+    }
+    case nlohmann::json::value_t::object: {
+      PyObject* dict = PyDict_New();
+      for (const auto& [key, item] : j.items()) {
+        PyObject* value = json_to_python(item);
+        PyDict_SetItemString(dict, key.c_str(), value);
+        Py_DECREF(value);
+      }
+      return dict;
+    }
+    default:
+      Py_RETURN_NONE;
+  }
+}
+
+PyObject* import_compute_bid(const std::string& python_script_name)
+{
+  std::lock_guard<std::mutex> lock(interpreter_mutex);
+  if (not Py_IsInitialized()) {
+    Py_InitializeEx(0); // do not steal the simulator's signal handlers
+    // Release the GIL acquired by the initialization. Each call re-acquires it through GILGuard.
+    PyEval_SaveThread();
+  }
+
+  auto it = compute_bid_functions.find(python_script_name);
+  if (it != compute_bid_functions.end())
+    return it->second;
+
+  GILGuard gil;
+  auto script_path = std::filesystem::absolute(python_script_name);
+  auto module_name = script_path.stem().string();
+
+  // Bidders import each other (e.g., CentralizedScheduling imports EmbeddingBidding)
+  PyObject* sys_path = PySys_GetObject("path"); // borrowed
+  PyObject* script_dir = PyUnicode_FromString(script_path.parent_path().c_str());
+  if (PySequence_Contains(sys_path, script_dir) == 0)
+    PyList_Insert(sys_path, 0, script_dir);
+  Py_DECREF(script_dir);
+
+  PyObject* module = PyImport_ImportModule(module_name.c_str());
+  if (not module)
+    throw std::runtime_error("Failed to import " + python_script_name + ": " + fetch_python_error());
+
+  PyObject* function = PyObject_GetAttrString(module, "compute_bid");
+  if (not function || not PyCallable_Check(function)) {
+    Py_XDECREF(function);
+    Py_DECREF(module);
+    PyErr_Clear();
+    throw std::runtime_error(python_script_name + " does not define a compute_bid function");
+  }
+
+  // A compute_bid imported from another script (e.g. the heuristic fallback of LLM bidders) is not the bidder itself
+  PyObject* defined_in = PyObject_GetAttrString(function, "__module__");
+  bool is_own_function = defined_in && PyUnicode_Check(defined_in) && module_name == PyUnicode_AsUTF8(defined_in);
+  Py_XDECREF(defined_in);
+  PyErr_Clear();
+  Py_DECREF(module); // the function keeps its module globals alive
+  if (not is_own_function) {
+    Py_DECREF(function);
+    throw std::runtime_error(python_script_name +
+                             " does not define its own compute_bid function and cannot be embedded");
+  }
+
+  compute_bid_functions[python_script_name] = function; // never released, the interpreter lives until exit
+  return function;
+}
+
+} // namespace
+
+EmbeddedPythonBidderBackend::EmbeddedPythonBidderBackend(const std::string& python_script_name)
+    : python_script_name_(python_script_name)
+{
+  if (not std::filesystem::exists(python_script_name_))
+    throw std::runtime_error("Python script not found: " + python_script_name_);
+  compute_bid_function_ = import_compute_bid(python_script_name_);
+}
+
+nlohmann::json EmbeddedPythonBidderBackend::run(const nlohmann::json& input)
+{
+  auto function = static_cast<PyObject*>(compute_bid_function_);
+  GILGuard gil;
+
+  PyObject* args = PyTuple_New(4);
+  PyTuple_SET_ITEM(args, 0, json_to_python(input.at("job_description")));
+  PyTuple_SET_ITEM(args, 1, json_to_python(input.at("hpc_system_description")));
+  PyTuple_SET_ITEM(args, 2, json_to_python(input.at("hpc_system_status")));
+  PyTuple_SET_ITEM(args, 3, PyFloat_FromDouble(input.value("current_simulated_time", 0.0)));
+
+  auto start      = std::chrono::steady_clock::now();
+  PyObject* value = PyObject_CallObject(function, args);
+  auto elapsed    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  Py_DECREF(args);
+
+  if (not value)
+    return {{"error", fetch_python_error()}};
+
+  double bid = PyFloat_AsDouble(value);
+  Py_DECREF(value);
+  if (PyErr_Occurred())
+    return {{"error", "compute_bid did not return a number: " + fetch_python_error()}};
+
+  // As the wrappers of the other backends, which report round(elapsed, 6)
+  return {{"bid", bid}, {"bid_generation_time_seconds", std::round(elapsed * 1e6) / 1e6}};
+}
+
+#else
+
+EmbeddedPythonBidderBackend::EmbeddedPythonBidderBackend(const std::string& python_script_name)
+    : python_script_name_(python_script_name)
+{
+  throw std::runtime_error("The embedded bidder backend requires swarm_dmas to be built with ENABLE_EMBEDDED_PYTHON");
+}
+
+nlohmann::json EmbeddedPythonBidderBackend::run(const nlohmann::json& /*input*/)
+{
+  return {{"error", "embedded bidder backend not available"}};
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "utils/MessageOutbox.h"
+#include "messages/ControlMessages.h"
+
+MessageOutbox::~MessageOutbox()
+{
+  for (auto& [destination, messages] : pending_messages_)
+    for (auto message : messages)
+      delete message;
+}
+
+void MessageOutbox::send(const std::shared_ptr<wrench::S4U_Daemon>& destination, Message* message)
+{
+  num_messages_++;
+  if (not coalescing_) {
+    num_sent_messages_++;
+    destination->commport->dputMessage(message);
+    return;
+  }
+  auto [it, inserted] = destinations_.try_emplace(destination.get(), pending_messages_.size());
+  if (inserted)
+    pending_messages_.emplace_back(destination, std::vector<Message*>());
+  pending_messages_[it->second].second.push_back(message);
+}
+
+void MessageOutbox::flush()
+{
+  for (auto& [destination, messages] : pending_messages_) {
+    num_sent_messages_++;
+    if (messages.size() == 1)
+      destination->commport->dputMessage(messages.front());
+    else
+      destination->commport->dputMessage(new wrench::CoalescedMessage(messages));
+  }
+  pending_messages_.clear();
+  destinations_.clear();
+}
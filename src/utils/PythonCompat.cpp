@@ -0,0 +1,168 @@
+#include "utils/PythonCompat.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// MD5 (RFC 1321)
+constexpr uint32_t MD5_SHIFTS[64] = {7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+                                     5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20, 5, 9,  14, 20,
+                                     4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+                                     6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21};
+
+constexpr uint32_t MD5_CONSTANTS[64] = {
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391};
+
+inline uint32_t rotate_left(uint32_t x, uint32_t c) { return (x << c) | (x >> (32 - c)); }
+
+} // namespace
+
+std::string md5_hex(const std::string& s)
+{
+  uint32_t a0 = 0x67452301, b0 = 0xefcdab89, c0 = 0x98badcfe, d0 = 0x10325476;
+
+  // Padding: 0x80, zeros up to 56 mod 64, then the message length in bits (little endian)
+  std::string message = s;
+  uint64_t bit_length = static_cast<uint64_t>(s.size()) * 8;
+  message.push_back(static_cast<char>(0x80));
+  while (message.size() % 64 != 56)
+    message.push_back(0);
+  for (int i = 0; i < 8; i++)
+    message.push_back(static_cast<char>((bit_length >> (8 * i)) & 0xff));
+
+  for (size_t chunk = 0; chunk < message.size(); chunk += 64) {
+    uint32_t w[16];
+    for (int i = 0; i < 16; i++) {
+      const auto* p = reinterpret_cast<const unsigned char*>(message.data() + chunk + 4 * i);
+      w[i]          = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+    uint32_t a = a0, b = b0, c = c0, d = d0;
+    for (uint32_t i = 0; i < 64; i++) {
+      uint32_t f, g;
+      if (i < 16) {
+        f = (b & c) | (~b & d);
+        g = i;
+      } else if (i < 32) {
+        f = (d & b) | (~d & c);
+        g = (5 * i + 1) % 16;
+      } else if (i < 48) {
+        f = b ^ c ^ d;
+        g = (3 * i + 5) % 16;
+      } else {
+        f = c ^ (b | ~d);
+        g = (7 * i) % 16;
+      }
+      f = f + a + MD5_CONSTANTS[i] + w[g];
+      a = d;
+      d = c;
+      c = b;
+      b = b + rotate_left(f, MD5_SHIFTS[i]);
+    }
+    a0 += a;
+    b0 += b;
+    c0 += c;
+    d0 += d;
+  }
+
+  std::string digest;
+  char hex[3];
+  for (uint32_t word : {a0, b0, c0, d0})
+    for (int i = 0; i < 4; i++) {
+      std::snprintf(hex, sizeof(hex), "%02x", (word >> (8 * i)) & 0xff);
+      digest += hex;
+    }
+  return digest;
+}
+
+uint32_t md5_seed(const std::string& s)
+{
+  return static_cast<uint32_t>(std::strtoul(md5_hex(s).substr(0, 8).c_str(), nullptr, 16));
+}
+
+double python_round(double x, int ndigits)
+{
+  // Like CPython, go through the correctly rounded decimal representation and parse it back
+  char buffer[64];
+  std::snprintf(buffer, sizeof(buffer), "%.*f", ndigits, x);
+  return std::strtod(buffer, nullptr);
+}
+
+PythonRandom::PythonRandom(uint32_t seed)
+{
+  // random.seed(n) for 0 <= n < 2^32 calls init_by_array with the single 32-bit word key [n]
+  init_genrand(19650218U);
+  int i = 1;
+  int j = 0;
+  for (int k = N; k; k--) {
+    state_[i] = (state_[i] ^ ((state_[i - 1] ^ (state_[i - 1] >> 30)) * 1664525U)) + seed + j;
+    i++;
+    j = 0; // the key has a single element
+    if (i >= N) {
+      state_[0] = state_[N - 1];
+      i         = 1;
+    }
+  }
+  for (int k = N - 1; k; k--) {
+    state_[i] = (state_[i] ^ ((state_[i - 1] ^ (state_[i - 1] >> 30)) * 1566083941U)) - i;
+    i++;
+    if (i >= N) {
+      state_[0] = state_[N - 1];
+      i         = 1;
+    }
+  }
+  state_[0] = 0x80000000U;
+  index_    = N;
+}
+
+void PythonRandom::init_genrand(uint32_t s)
+{
+  state_[0] = s;
+  for (int i = 1; i < N; i++)
+    state_[i] = 1812433253U * (state_[i - 1] ^ (state_[i - 1] >> 30)) + i;
+  index_ = N;
+}
+
+uint32_t PythonRandom::genrand_uint32()
+{
+  constexpr uint32_t UPPER_MASK = 0x80000000U;
+  constexpr uint32_t LOWER_MASK = 0x7fffffffU;
+  constexpr uint32_t MATRIX_A   = 0x9908b0dfU;
+
+  if (index_ >= N) {
+    int k = 0;
+    for (; k < N - M; k++) {
+      uint32_t y = (state_[k] & UPPER_MASK) | (state_[k + 1] & LOWER_MASK);
+      state_[k]  = state_[k + M] ^ (y >> 1) ^ ((y & 1U) ? MATRIX_A : 0U);
+    }
+    for (; k < N - 1; k++) {
+      uint32_t y = (state_[k] & UPPER_MASK) | (state_[k + 1] & LOWER_MASK);
+      state_[k]  = state_[k + (M - N)] ^ (y >> 1) ^ ((y & 1U) ? MATRIX_A : 0U);
+    }
+    uint32_t y    = (state_[N - 1] & UPPER_MASK) | (state_[0] & LOWER_MASK);
+    state_[N - 1] = state_[M - 1] ^ (y >> 1) ^ ((y & 1U) ? MATRIX_A : 0U);
+    index_        = 0;
+  }
+
+  uint32_t y = state_[index_++];
+  y ^= (y >> 11);
+  y ^= (y << 7) & 0x9d2c5680U;
+  y ^= (y << 15) & 0xefc60000U;
+  y ^= (y >> 18);
+  return y;
+}
+
+double PythonRandom::random()
+{
+  uint32_t a = genrand_uint32() >> 5;
+  uint32_t b = genrand_uint32() >> 6;
+  return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+}